@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+#
+# Runs every benchmark on every engine and prints the best wall-clock time of each as a Markdown table, after checking
+# that all engines print the same output.
+#
+# Usage: bench/compare.sh <lox binary> [runs (default 3)] [engines (default "tree vm register")]
+#
+
+set -euo pipefail
+
+if [[ $# -lt 1 ]]; then
+    echo "Usage: $0 <lox binary> [runs] [engines]" >&2
+    exit 1
+fi
+
+lox=$1
+runs=${2:-3}
+read -r -a engines <<< "${3:-tree vm register}"
+directory=$(dirname "$0")
+
+TIMEFORMAT=%R
+
+# the best of $runs wall-clock times of a benchmark on an engine, in seconds
+best() {
+    local best=
+    for ((run = 0; run < runs; ++run)); do
+        local time
+        time=$( { time "$lox" --engine="$1" "$2" > /dev/null; } 2>&1 )
+        if [[ -z $best ]] || awk "BEGIN { exit !($time < $best) }"; then
+            best=$time
+        fi
+    done
+    echo "$best"
+}
+
+header="| Benchmark |"
+separator="|-----------|"
+for engine in "${engines[@]}"; do
+    header+=" $engine |"
+    separator+="------:|"
+done
+echo "$header"
+echo "$separator"
+
+for benchmark in "$directory"/*.lox; do
+    name=$(basename "$benchmark")
+    expected=$("$lox" --engine="${engines[0]}" "$benchmark" 2>&1)
+
+    row="| \`$name\` |"
+    for engine in "${engines[@]}"; do
+        if [[ $("$lox" --engine="$engine" "$benchmark" 2>&1) != "$expected" ]]; then
+            echo "$name: the output of --engine=$engine differs from --engine=${engines[0]}" >&2
+            exit 1
+        fi
+        row+=" $(best "$engine" "$benchmark") s |"
+    done
+    echo "$row"
+done
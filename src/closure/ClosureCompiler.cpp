@@ -0,0 +1,560 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "ClosureCompiler.h"
+
+#include "interpreter/RuntimeError.h"
+#include "interpreter/LoxObject.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+template<typename Operation>
+Evaluator arithmetic(Evaluator left, Evaluator right, Token_ptr token, Operation op) {
+    // numbers need not be kept reachable, and anything else is an error, so neither operand is pushed
+    return [left = move(left), right = move(right), token = move(token), op](Frame &frame) {
+        auto l = left(frame);
+        auto r = right(frame);
+
+        if (not (l.isNumber() and r.isNumber())) {
+            throw RuntimeError(*token, "Operands of arithmetic operation (+, -, *, /) must be of type Number.");
+        }
+
+        return Value::number(op(l.asNumber(), r.asNumber()));
+    };
+}
+
+template<typename Operation>
+Evaluator comparison(Evaluator left, Evaluator right, Token_ptr token, Operation op) {
+    return [left = move(left), right = move(right), token = move(token), op](Frame &frame) {
+        auto l = left(frame);
+        auto r = right(frame);
+
+        if (not (l.isNumber() and r.isNumber())) {
+            throw RuntimeError(*token, "Operands of arithmetic comparison (>, >=, <, <=) must be of type Number.");
+        }
+
+        return Value::boolean(op(l.asNumber(), r.asNumber()));
+    };
+}
+
+template<typename Operation>
+Evaluator equality(ClosureEngine &engine, Evaluator left, Evaluator right, Operation op) {
+    return [engine = &engine, left = move(left), right = move(right), op](Frame &frame) {
+        auto l = left(frame);
+
+        if (l.isNumber()) {
+            return Value::boolean(op(l, right(frame)));
+        }
+
+        // the left operand stays reachable while the right one is evaluated
+        engine->push(l);
+        auto result = Value::boolean(op(l, right(frame)));
+        engine->pop();
+
+        return result;
+    };
+}
+
+Evaluator constant(Value value) {
+    return [value](Frame &frame) { return value; };
+}
+
+}
+
+shared_ptr<CompiledBody> compileClosures(const vector<Statement_ptr> &statements, size_t slots, ClosureEngine &engine) {
+    ClosureCompiler compiler {engine};
+    return compiler.compile(statements, slots);
+}
+
+ClosureCompiler::ClosureCompiler(ClosureEngine &engine) : engine{engine} {}
+
+shared_ptr<CompiledBody> ClosureCompiler::compile(const vector<Statement_ptr> &statements, size_t slots) {
+    return compileBody(statements, slots);
+}
+
+shared_ptr<CompiledBody> ClosureCompiler::compileBody(const vector<Statement_ptr> &statements, size_t slots) {
+    auto compiled = make_shared<CompiledBody>();
+
+    // retain the enclosing function's state
+    auto enclosingDepth = depth;
+    auto enclosingMaxDepth = maxDepth;
+
+    depth = 0;
+    maxDepth = 0;
+
+    for (const auto &statement : statements) {
+        compiled->statements.push_back(compile(*statement));
+    }
+
+    compiled->stackSize = slots + maxDepth;
+
+    depth = enclosingDepth;
+    maxDepth = enclosingMaxDepth;
+
+    return compiled;
+}
+
+Executor ClosureCompiler::compile(Statement &statement) {
+    statement.accept(*this);
+    return move(executor);
+}
+
+Evaluator ClosureCompiler::compile(Expression &expression) {
+    expression.accept(*this);
+    return move(evaluator);
+}
+
+Evaluator ClosureCompiler::compileAbove(Expression &expression, size_t count) {
+    depth += count;
+    maxDepth = max(maxDepth, depth);
+
+    auto compiled = compile(expression);
+    depth -= count;
+
+    return compiled;
+}
+
+vector<Evaluator> ClosureCompiler::arguments(Call &call) {
+    vector<Evaluator> compiled;
+    compiled.push_back(compile(*call.callee));
+
+    for (const auto &argument : call.arguments) {
+        compiled.push_back(compileAbove(*argument, compiled.size()));
+    }
+
+    maxDepth = max(maxDepth, depth + compiled.size());
+    return compiled;
+}
+
+
+// Statement Visitor
+
+void ClosureCompiler::visit(ExpressionStatement &statement) {
+    executor = [expression = compile(*statement.expression)](Frame &frame) {
+        expression(frame);
+        return Completion::NORMAL;
+    };
+}
+
+void ClosureCompiler::visit(Print &statement) {
+    executor = [expression = compile(*statement.expression)](Frame &frame) {
+        cout << expression(frame) << "\n";
+        return Completion::NORMAL;
+    };
+}
+
+void ClosureCompiler::visit(Block &statement) {
+    // the block's variables have their own slots in the current frame
+    vector<Executor> statements;
+
+    for (const auto &s : statement.statements) {
+        statements.push_back(compile(*s));
+    }
+
+    executor = [statements = move(statements)](Frame &frame) {
+        for (const auto &statement : statements) {
+            auto completion = statement(frame);
+
+            if (completion != Completion::NORMAL) {
+                return completion;
+            }
+        }
+
+        return Completion::NORMAL;
+    };
+}
+
+void ClosureCompiler::visit(Var &statement) {
+    auto initializer = statement.initializer ? compile(*statement.initializer) : constant(Value::nil());
+    auto slot = statement.slot;
+
+    switch (statement.access) {
+        case Access::GLOBAL: {
+            auto index = engine.globals.bind(statement.name->lexeme);
+
+            executor = [engine = &engine, initializer = move(initializer), index](Frame &frame) {
+                engine->globals.define(index, initializer(frame));
+                return Completion::NORMAL;
+            };
+            break;
+        }
+
+        case Access::LOCAL:
+            executor = [initializer = move(initializer), slot](Frame &frame) {
+                frame.slots[slot] = initializer(frame);
+                return Completion::NORMAL;
+            };
+            break;
+
+        case Access::CELL:
+            maxDepth = max(maxDepth, depth + 1);
+
+            // a new Cell on every execution, so closures created in different iterations of a loop don't share it
+            executor = [engine = &engine, initializer = move(initializer), slot](Frame &frame) {
+                auto value = initializer(frame);
+
+                engine->push(value);
+                frame.slots[slot] = Cell::New(value);
+                engine->pop();
+
+                return Completion::NORMAL;
+            };
+            break;
+
+        case Access::UPVALUE: ; // Unreachable, declarations are never upvalues
+    }
+}
+
+void ClosureCompiler::visit(If &statement) {
+    auto condition = compile(*statement.condition);
+    auto thenBranch = compile(*statement.thenBranch);
+
+    if (not statement.elseBranch) {
+        executor = [condition = move(condition), thenBranch = move(thenBranch)](Frame &frame) {
+            return condition(frame).isTruthy() ? thenBranch(frame) : Completion::NORMAL;
+        };
+        return;
+    }
+
+    executor = [condition = move(condition), thenBranch = move(thenBranch), elseBranch = compile(*statement.elseBranch)](
+        Frame &frame
+    ) {
+        return condition(frame).isTruthy() ? thenBranch(frame) : elseBranch(frame);
+    };
+}
+
+void ClosureCompiler::visit(While &statement) {
+    executor = [condition = compile(*statement.condition), body = compile(*statement.body)](Frame &frame) {
+        while (condition(frame).isTruthy()) {
+            auto completion = body(frame);
+
+            if (completion != Completion::NORMAL) {
+                return completion;
+            }
+        }
+
+        return Completion::NORMAL;
+    };
+}
+
+void ClosureCompiler::visit(Function &statement) {
+    statement.compiled = compileBody(statement.body, statement.frameSize);
+
+    // sharing the declaration keeps the syntax tree and the compiled body alive as long as the function
+    auto declaration = statement.shared_from_this();
+    auto slot = statement.slot;
+
+    switch (statement.access) {
+        case Access::GLOBAL: {
+            auto index = engine.globals.bind(statement.name->lexeme);
+
+            executor = [engine = &engine, declaration, index](Frame &frame) {
+                engine->globals.define(index, FunctionObject::New(declaration, frame.slots, frame.function));
+                return Completion::NORMAL;
+            };
+            break;
+        }
+
+        case Access::LOCAL:
+            executor = [declaration, slot](Frame &frame) {
+                frame.slots[slot] = FunctionObject::New(declaration, frame.slots, frame.function);
+                return Completion::NORMAL;
+            };
+            break;
+
+        case Access::CELL:
+            // a function that refers to itself captures its own variable, so the Cell has to exist before the closure
+            executor = [declaration, slot](Frame &frame) {
+                frame.slots[slot] = Cell::New(Value::nil());
+
+                auto closure = FunctionObject::New(declaration, frame.slots, frame.function);
+                frame.slots[slot].as<Cell>()->set(closure);
+
+                return Completion::NORMAL;
+            };
+            break;
+
+        case Access::UPVALUE: ; // Unreachable, declarations are never upvalues
+    }
+}
+
+void ClosureCompiler::visit(Return &statement) {
+    if (statement.tailCall) {
+        auto &call = *statement.tailCall;
+        auto count = static_cast<int>(call.arguments.size());
+
+        executor = [engine = &engine, arguments = arguments(call), count, paren = call.paren](Frame &frame) {
+            auto base = engine->stackTop();
+
+            for (const auto &argument : arguments) {
+                engine->push(argument(frame));
+            }
+
+            return engine->tailCall(frame, base, count, *paren);
+        };
+        return;
+    }
+
+    auto value = statement.value ? compile(*statement.value) : constant(Value::nil());
+
+    executor = [value = move(value)](Frame &frame) {
+        frame.result = value(frame);
+        return Completion::RETURN;
+    };
+}
+
+
+// Expression Visitor
+
+void ClosureCompiler::visit(Binary &expression) {
+    auto &token = expression.token;
+    auto left = compile(*expression.left);
+
+    switch (token->type) {
+        case TokenType::MINUS: {
+            auto right = compile(*expression.right);
+            evaluator = arithmetic(move(left), move(right), token, [](double l, double r) { return l - r; });
+            break;
+        }
+
+        case TokenType::SLASH: {
+            auto right = compile(*expression.right);
+            evaluator = arithmetic(move(left), move(right), token, [](double l, double r) { return l / r; });
+            break;
+        }
+
+        case TokenType::STAR: {
+            auto right = compile(*expression.right);
+            evaluator = arithmetic(move(left), move(right), token, [](double l, double r) { return l * r; });
+            break;
+        }
+
+        case TokenType::GREATER: {
+            auto right = compile(*expression.right);
+            evaluator = comparison(move(left), move(right), token, [](double l, double r) { return l > r; });
+            break;
+        }
+
+        case TokenType::GREATER_EQUAL: {
+            auto right = compile(*expression.right);
+            evaluator = comparison(move(left), move(right), token, [](double l, double r) { return l >= r; });
+            break;
+        }
+
+        case TokenType::LESS: {
+            auto right = compile(*expression.right);
+            evaluator = comparison(move(left), move(right), token, [](double l, double r) { return l < r; });
+            break;
+        }
+
+        case TokenType::LESS_EQUAL: {
+            auto right = compile(*expression.right);
+            evaluator = comparison(move(left), move(right), token, [](double l, double r) { return l <= r; });
+            break;
+        }
+
+        case TokenType::BANG_EQUAL: {
+            auto right = compileAbove(*expression.right, 1);
+            evaluator = equality(engine, move(left), move(right), [](Value l, Value r) { return l != r; });
+            break;
+        }
+
+        case TokenType::EQUAL_EQUAL: {
+            auto right = compileAbove(*expression.right, 1);
+            evaluator = equality(engine, move(left), move(right), [](Value l, Value r) { return l == r; });
+            break;
+        }
+
+        case TokenType::PLUS: {
+            auto right = compileAbove(*expression.right, 1);
+            maxDepth = max(maxDepth, depth + 2);
+
+            evaluator = [engine = &engine, left = move(left), right = move(right), token](Frame &frame) {
+                auto l = left(frame);
+
+                // a number can only be added to a number
+                if (l.isNumber()) {
+                    auto r = right(frame);
+
+                    if (not r.isNumber()) {
+                        throw RuntimeError(*token, plusError(l));
+                    }
+
+                    return Value::number(l.asNumber() + r.asNumber());
+                }
+
+                // both operands stay reachable while the result is allocated
+                engine->push(l);
+                auto r = right(frame);
+                engine->push(r);
+
+                auto handler = plusHandlers[size_t(kindOf(l))][size_t(kindOf(r))];
+
+                if (not handler) {
+                    throw RuntimeError(*token, plusError(l));
+                }
+
+                auto result = handler(l, r);
+                engine->pop(2);
+
+                return result;
+            };
+            break;
+        }
+
+        default: ; // Unreachable
+    }
+}
+
+void ClosureCompiler::visit(Grouping &expression) {
+    evaluator = compile(*expression.content);
+}
+
+void ClosureCompiler::visit(Literal &expression) {
+    const string &lexeme = expression.token->lexeme;
+
+    switch (expression.token->type) {
+        case TokenType::NIL: evaluator = constant(Value::nil()); break;
+        case TokenType::TRUE: evaluator = constant(Value::boolean(true)); break;
+        case TokenType::FALSE: evaluator = constant(Value::boolean(false)); break;
+        case TokenType::NUMBER: evaluator = constant(Value::number(stod(lexeme))); break;
+
+        // interned Strings are pinned, since closures aren't traced
+        case TokenType::STRING: evaluator = constant(String::NewSymbol(lexeme.substr(1, lexeme.length() - 2))); break;
+
+        default: ;
+    }
+}
+
+void ClosureCompiler::visit(Logical &expression) {
+    auto left = compile(*expression.left);
+    auto right = compile(*expression.right);
+
+    if (expression.token->type == TokenType::AND) {
+        // a and b = b if a, else a
+        evaluator = [left = move(left), right = move(right)](Frame &frame) {
+            auto value = left(frame);
+            return value.isTruthy() ? right(frame) : value;
+        };
+    } else {
+        // a or b = a if a, else b
+        evaluator = [left = move(left), right = move(right)](Frame &frame) {
+            auto value = left(frame);
+            return value.isTruthy() ? value : right(frame);
+        };
+    }
+}
+
+void ClosureCompiler::visit(Unary &expression) {
+    auto operand = compile(*expression.operand);
+
+    if (expression.token->type == TokenType::MINUS) {
+        evaluator = [operand = move(operand), token = expression.token](Frame &frame) {
+            auto value = operand(frame);
+
+            if (not value.isNumber()) {
+                throw RuntimeError(*token, "Operand of unary minus (-) must be of type Number.");
+            }
+
+            return Value::number(-value.asNumber());
+        };
+    } else {
+        evaluator = [operand = move(operand)](Frame &frame) {
+            return Value::boolean(not operand(frame).isTruthy());
+        };
+    }
+}
+
+void ClosureCompiler::visit(Variable &expression) {
+    auto slot = expression.slot;
+
+    switch (expression.access) {
+        case Access::GLOBAL: {
+            auto index = engine.globals.bind(expression.name->lexeme);
+
+            evaluator = [engine = &engine, index, name = expression.name](Frame&) {
+                return engine->globals.get(index, *name);
+            };
+            break;
+        }
+
+        case Access::LOCAL:
+            evaluator = [slot](Frame &frame) {
+                return frame.slots[slot];
+            };
+            break;
+
+        case Access::CELL:
+            evaluator = [slot](Frame &frame) {
+                return frame.slots[slot].as<Cell>()->get();
+            };
+            break;
+
+        case Access::UPVALUE:
+            evaluator = [slot](Frame &frame) {
+                return frame.function->upvalues()[slot]->get();
+            };
+            break;
+    }
+}
+
+void ClosureCompiler::visit(Assign &expression) {
+    auto value = compile(*expression.value);
+    auto slot = expression.slot;
+
+    switch (expression.access) {
+        case Access::GLOBAL: {
+            auto index = engine.globals.bind(expression.name->lexeme);
+
+            evaluator = [engine = &engine, value = move(value), index, name = expression.name](Frame &frame) {
+                auto result = value(frame);
+                engine->globals.assign(index, *name, result);
+                return result;
+            };
+            break;
+        }
+
+        case Access::LOCAL:
+            evaluator = [value = move(value), slot](Frame &frame) {
+                return frame.slots[slot] = value(frame);
+            };
+            break;
+
+        case Access::CELL:
+            evaluator = [value = move(value), slot](Frame &frame) {
+                auto result = value(frame);
+                frame.slots[slot].as<Cell>()->set(result);
+                return result;
+            };
+            break;
+
+        case Access::UPVALUE:
+            evaluator = [value = move(value), slot](Frame &frame) {
+                auto result = value(frame);
+                frame.function->upvalues()[slot]->set(result);
+                return result;
+            };
+            break;
+    }
+}
+
+void ClosureCompiler::visit(Call &expression) {
+    auto count = static_cast<int>(expression.arguments.size());
+
+    evaluator = [engine = &engine, arguments = arguments(expression), count, paren = expression.paren](Frame &frame) {
+        auto base = engine->stackTop();
+
+        // callee and arguments stay on the stack (and thus alive) until the call returns
+        for (const auto &argument : arguments) {
+            engine->push(argument(frame));
+        }
+
+        return engine->call(base, count, *paren);
+    };
+}
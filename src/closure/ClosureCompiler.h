@@ -0,0 +1,80 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_CLOSURECOMPILER_H
+#define LOX_INTERPRETER_CLOSURECOMPILER_H
+
+#include "ClosureEngine.h"
+#include "data/expression.h"
+#include "data/statement.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// compiles a resolved program into closures for its top-level code, given the size of the top-level frame
+std::shared_ptr<CompiledBody> compileClosures(const std::vector<Statement_ptr> &statements, std::size_t slots,
+                                              ClosureEngine &engine);
+
+/*
+ * Translates the syntax tree, as annotated by the Resolver, into a tree of closures that run on the ClosureEngine.
+ * Every node becomes a closure specialized for what the tree walker would decide on each evaluation: the operator, how
+ * a variable is accessed and where, the value of a literal. Evaluating a closure calls its operands' closures directly
+ * and returns the value, so there is no double dispatch through `accept` and `visit` and no round trip through the
+ * Interpreter's `temporary`. Every function declaration is compiled into its own CompiledBody, stored in the
+ * declaration; globals are bound to their index in the Globals at compile time.
+ */
+class ClosureCompiler : public ExpressionVisitor, StatementVisitor {
+
+public:
+    explicit ClosureCompiler(ClosureEngine &engine);
+
+    std::shared_ptr<CompiledBody> compile(const std::vector<Statement_ptr> &statements, std::size_t slots);
+
+    // Member functions for Statement visitor interface
+    void visit(ExpressionStatement &statement) override;
+    void visit(Print &statement) override;
+    void visit(Block &statement) override;
+    void visit(Var &statement) override;
+    void visit(If &statement) override;
+    void visit(While &statement) override;
+    void visit(Function &statement) override;
+    void visit(Return &statement) override;
+
+    // Member functions for Expression visitor interface
+    void visit(Binary &expression) override;
+    void visit(Grouping &expression) override;
+    void visit(Literal &expression) override;
+    void visit(Logical &expression) override;
+    void visit(Unary &expression) override;
+    void visit(Variable &expression) override;
+    void visit(Assign &expression) override;
+    void visit(Call &expression) override;
+
+private:
+    ClosureEngine &engine;
+
+    // the closure compiled from the last node visited
+    Evaluator evaluator;
+    Executor executor;
+
+    // the number of temporaries on the engine's stack at the current point of the body being compiled, and the most
+    // there are at any point
+    std::size_t depth = 0;
+    std::size_t maxDepth = 0;
+
+    Executor compile(Statement &statement);
+    Evaluator compile(Expression &expression);
+
+    // compiles an expression with `count` more temporaries on the stack
+    Evaluator compileAbove(Expression &expression, std::size_t count);
+
+    std::shared_ptr<CompiledBody> compileBody(const std::vector<Statement_ptr> &statements, std::size_t slots);
+
+    // compiles the callee and arguments of a call, which are pushed onto the stack in order
+    std::vector<Evaluator> arguments(Call &call);
+};
+
+
+#endif //LOX_INTERPRETER_CLOSURECOMPILER_H
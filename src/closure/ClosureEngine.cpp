@@ -0,0 +1,109 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "ClosureEngine.h"
+
+#include "interpreter/RuntimeError.h"
+#include "data/statement.h"
+
+#include <algorithm>
+
+using namespace std;
+
+ClosureEngine::ClosureEngine(Interpreter &interpreter)
+    : interpreter{interpreter}, globals{*interpreter.globals}, stack(STACK_SIZE), top{stack.data()} {
+
+    interpreter.heap.addRoots(this);
+}
+
+ClosureEngine::~ClosureEngine() {
+    interpreter.heap.removeRoots(this);
+}
+
+void ClosureEngine::markRoots(Heap &heap) {
+    for (auto value = stack.data(); value < top; ++value) {
+        heap.mark(*value);
+    }
+}
+
+void ClosureEngine::interpret(const CompiledBody &script, size_t slots) {
+    // discard frames and temporaries left behind by a runtime error in a previous run
+    top = stack.data() + slots;
+    fill(stack.data(), top, Value::nil());
+
+    Frame frame {stack.data(), nullptr, Value::nil()};
+    script.execute(frame);
+
+    top = stack.data();
+}
+
+void ClosureEngine::checkCall(const Value &callee, int count, const Token &paren) const {
+    auto callable = callee.is<Callable>() ? callee.as<Callable>() : nullptr;
+
+    if (not callable) {
+        throw RuntimeError(paren, "Can only call functions and classes.");
+    }
+
+    if (count != callable->arity()) {
+        throw RuntimeError(
+            paren, "Expected " + to_string(callable->arity()) + " arguments but got " + to_string(count) + "."
+        );
+    }
+}
+
+Value ClosureEngine::call(Value *base, int count, const Token &paren) {
+    checkCall(*base, count, paren);
+
+    if (base->is<Native>()) {
+        auto result = base->as<Native>()->invoke(interpreter, base + 1);
+        top = base;
+        return result;
+    }
+
+    Frame frame {base + 1, base->as<FunctionObject>(), Value::nil()};
+
+    // tail calls run in the same frame, one after another
+    while (true) {
+        auto &declaration = *frame.function->declaration;
+        auto &body = *declaration.compiled;
+
+        if (frame.slots + body.stackSize > stack.data() + stack.size()) {
+            throw RuntimeError(paren, "Stack overflow.");
+        }
+
+        // the locals after the parameters start out nil
+        auto end = frame.slots + declaration.frameSize;
+        fill(top, end, Value::nil());
+        top = end;
+
+        // captured parameters move into Cells before the body can create closures over them
+        for (auto slot : declaration.cells) {
+            frame.slots[slot] = Cell::New(frame.slots[slot]);
+        }
+
+        auto completion = body.execute(frame);
+
+        if (completion != Completion::TAIL_CALL) {
+            top = base;
+            return completion == Completion::RETURN ? frame.result : Value::nil();
+        }
+
+        frame.function = frame.slots[-1].as<FunctionObject>();
+    }
+}
+
+Completion ClosureEngine::tailCall(Frame &frame, Value *base, int count, const Token &paren) {
+    checkCall(*base, count, paren);
+
+    if (base->is<FunctionObject>()) {
+        // the callee and its arguments take the place of the current function and its frame
+        move(base, base + count + 1, frame.slots - 1);
+        top = frame.slots + count;
+
+        return Completion::TAIL_CALL;
+    }
+
+    frame.result = call(base, count, paren);
+    return Completion::RETURN;
+}
@@ -0,0 +1,115 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_CLOSUREENGINE_H
+#define LOX_INTERPRETER_CLOSUREENGINE_H
+
+#include "interpreter/Interpreter.h"
+#include "interpreter/Callable.h"
+#include "interpreter/Heap.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// the state of a call: its frame on the engine's stack, the function it runs (nullptr at the top level) and, once a
+// return statement has executed, the value it returned
+struct Frame {
+    Value *slots;
+    const FunctionObject *function;
+    Value result;
+};
+
+// How a statement completed, as for the tree-walking Interpreter. On a return the value is in the frame's result; on a
+// tail call the callee and its arguments have replaced the current function and its frame.
+enum class Completion {
+    NORMAL, RETURN, TAIL_CALL
+};
+
+// a compiled expression, evaluating to its value in the given frame
+using Evaluator = std::function<Value(Frame &frame)>;
+
+// a compiled statement, executing in the given frame
+using Executor = std::function<Completion(Frame &frame)>;
+
+// a function body (or the top level of a program) compiled by the ClosureCompiler
+struct CompiledBody {
+    std::vector<Executor> statements;
+
+    // the number of stack slots a call needs: its frame plus the most temporaries on the stack at once
+    std::size_t stackSize = 0;
+
+    // executes the statements in order until one of them completes abruptly
+    Completion execute(Frame &frame) const {
+        for (const auto &statement : statements) {
+            auto completion = statement(frame);
+
+            if (completion != Completion::NORMAL) {
+                return completion;
+            }
+        }
+
+        return Completion::NORMAL;
+    }
+};
+
+/*
+ * Runs programs compiled by the ClosureCompiler into trees of closures. Frames have the same layout as the tree-walking
+ * Interpreter's and live on a stack of Values, together with the operands that have to stay reachable while another
+ * operand is evaluated, like the left operand of a string concatenation. Lox calls nest on the native stack, as they
+ * do in the tree walker, except for tail calls, which reuse the frame.
+ *
+ * The engine runs on the Interpreter's heap and shares its globals, so the natives it defines are available, and
+ * registers its stack with the heap as roots.
+ */
+class ClosureEngine : public RootSet {
+
+public:
+    Interpreter &interpreter;
+    Globals &globals;
+
+    explicit ClosureEngine(Interpreter &interpreter);
+    ~ClosureEngine();
+
+    ClosureEngine(const ClosureEngine&) = delete;
+    ClosureEngine& operator=(const ClosureEngine&) = delete;
+
+    // runs the compiled top-level code of a program, given the size of the top-level frame
+    void interpret(const CompiledBody &script, std::size_t slots);
+
+    void markRoots(Heap &heap) override;
+
+    // keeps a value reachable until it is popped
+    void push(Value value) {
+        *top++ = value;
+    }
+
+    void pop(std::size_t count = 1) {
+        top -= count;
+    }
+
+    Value* stackTop() const {
+        return top;
+    }
+
+    // calls the value at base with the `count` values above it as arguments and pops them all
+    Value call(Value *base, int count, const Token &paren);
+
+    // returns the result of such a call from the current function, running a Lox callee in its frame
+    Completion tailCall(Frame &frame, Value *base, int count, const Token &paren);
+
+    // checks whether the callee can be called with `count` arguments
+    void checkCall(const Value &callee, int count, const Token &paren) const;
+
+private:
+    // Values, enough for thousands of nested calls
+    static constexpr std::size_t STACK_SIZE = 256 * 1024;
+
+    // frames point into the stack, so it never grows
+    std::vector<Value> stack;
+    Value *top;
+};
+
+
+#endif //LOX_INTERPRETER_CLOSUREENGINE_H
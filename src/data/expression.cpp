@@ -4,6 +4,8 @@
 
 #include "expression.h"
 
+#include "interpreter/CallSite.h"
+
 using namespace std;
 
 // Constructors
@@ -30,7 +32,7 @@ Assign::Assign(Token_ptr name, Expression_ptr value)
     : name{move(name)}, value{move(value)} {}
 
 Call::Call(Expression_ptr callee, Token_ptr paren, std::vector<Expression_ptr> &&arguments)
-    : callee{move(callee)}, paren{move(paren)}, arguments{move(arguments)} {}
+    : callee{move(callee)}, paren{move(paren)}, arguments{move(arguments)}, site{CallSite::New(this->paren)} {}
 
 
 // Factory functions
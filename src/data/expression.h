@@ -6,6 +6,7 @@
 #define LOX_INTERPRETER_AST_H
 
 #include "token.h"
+#include "interpreter/Value.h"
 
 #include <vector>
 
@@ -19,10 +20,38 @@ struct Unary;
 struct Variable;
 struct Assign;
 struct Call;
+struct CallSite;
 
 
 using Expression_ptr = std::shared_ptr<Expression>;
 
+// Where a variable lives, as determined by the Resolver
+enum class Access : std::uint8_t {
+    // in the Globals, addressed by name
+    GLOBAL,
+
+    // in the current call frame, at `slot`
+    LOCAL,
+
+    // in a Cell in the current call frame at `slot`, since a closure captures the variable
+    CELL,
+
+    // in the Cell the current function captured as its upvalue number `slot`
+    UPVALUE
+};
+
+// Index of a global variable that hasn't been looked up by name yet
+constexpr int UNBOUND = -1;
+
+/*
+ * Binary, Unary, Logical and Literal nodes specialize themselves on their first execution by the tree-walking Interpreter,
+ * for the operator and the types of operands they saw, and from then on skip the general dispatch. A specialization
+ * guards its assumptions on every execution; if they fail, the node falls back to the generic case for good, so it never
+ * flips back and forth. The state lives in the node itself (like the index of a bound global) rather than in a
+ * replacement node, since the Resolver and the compilers share the tree. Calls have an inline cache instead (see
+ * CallSite.h).
+ */
+
 
 /*
  * Visitor interface for Expressions
@@ -53,6 +82,24 @@ struct Binary : public Expression {
     Token_ptr token;
     Expression_ptr right;
 
+    enum class Specialization : std::uint8_t {
+        UNINITIALIZED,
+
+        // the operator on Numbers
+        ADD, SUBTRACT, MULTIPLY, DIVIDE, GREATER, GREATER_EQUAL, LESS, LESS_EQUAL,
+
+        // "+" on Strings
+        CONCATENATE,
+
+        // equality, which takes any operands
+        EQUAL, NOT_EQUAL,
+
+        // the operator on whatever operands it gets, checking their types
+        GENERIC
+    };
+
+    Specialization specialization = Specialization::UNINITIALIZED;
+
     explicit Binary(Expression_ptr left, Token_ptr token, Expression_ptr right);
     static std::shared_ptr<Binary> New(Expression_ptr left, Token_ptr token, Expression_ptr right);
 
@@ -73,6 +120,15 @@ struct Grouping : public Expression {
 struct Literal : public Expression {
     Token_ptr token;
 
+    // Literals always evaluate to the same Value, so they keep it once they have parsed it. A string literal's String is
+    // interned and pinned, like the constants of compiled code.
+    enum class Specialization : std::uint8_t {
+        UNINITIALIZED, CONSTANT
+    };
+
+    Specialization specialization = Specialization::UNINITIALIZED;
+    Value value;
+
     explicit Literal(Token_ptr token);
     static std::shared_ptr<Literal> New(Token_ptr token);
 
@@ -106,6 +162,13 @@ struct Unary : public Expression {
 struct Variable : public Expression {
     Token_ptr name;
 
+    // where the Resolver found the variable
+    Access access = Access::GLOBAL;
+    int slot = 0;
+
+    // for globals, the index into the Globals, bound by the Interpreter on first execution
+    int global = UNBOUND;
+
     explicit Variable(Token_ptr name);
     static std::shared_ptr<Variable> New(Token_ptr name);
 
@@ -117,6 +180,11 @@ struct Assign : public Expression {
     Token_ptr name;
     Expression_ptr  value;
 
+    // where the Resolver found the variable, as for Variable
+    Access access = Access::GLOBAL;
+    int slot = 0;
+    int global = UNBOUND;
+
     Assign(Token_ptr name, Expression_ptr value);
     static std::shared_ptr<Assign> New(Token_ptr name, Expression_ptr value);
 
@@ -129,6 +197,9 @@ struct Call : public Expression {
     Token_ptr paren; //closing!
     std::vector<Expression_ptr> arguments;
 
+    // the inline cache of the call, shared with the register VM's call instruction compiled from it
+    std::shared_ptr<CallSite> site;
+
     Call(Expression_ptr callee, Token_ptr paren, std::vector<Expression_ptr> &&arguments);
     static std::shared_ptr<Call> New(Expression_ptr callee, Token_ptr paren, std::vector<Expression_ptr> &&arguments);
 
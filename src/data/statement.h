@@ -5,6 +5,7 @@
 #ifndef LOX_INTERPRETER_STATEMENT_H
 #define LOX_INTERPRETER_STATEMENT_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 #include "expression.h"
@@ -21,6 +22,10 @@ struct While;
 struct Function;
 struct Return;
 
+struct Chunk;
+struct CompiledBody;
+struct LoxFunction;
+
 
 using Statement_ptr = std::shared_ptr<Statement>;
 
@@ -79,6 +84,10 @@ struct Var : public Statement {
     Token_ptr name;
     Expression_ptr initializer;
 
+    // where the variable lives, set by the Resolver
+    Access access = Access::GLOBAL;
+    int slot = 0;
+
     explicit Var(Token_ptr name, Expression_ptr initializer);
     static std::shared_ptr<Var> New(Token_ptr name, Expression_ptr initializer);
 
@@ -109,11 +118,42 @@ struct While : public Statement {
 };
 
 
-struct Function : public Statement {
+struct Function : public Statement, public std::enable_shared_from_this<Function> {
     Token_ptr name;
     std::vector<Token_ptr> parameters;
     std::vector<Statement_ptr> body;
 
+    // where the variable holding the function lives, set by the Resolver
+    Access access = Access::GLOBAL;
+    int slot = 0;
+
+    // A variable of an enclosing function this function captures: either a local of the directly enclosing function
+    // (the slot of its Cell in that function's frame) or one of the enclosing function's own upvalues.
+    struct Upvalue {
+        bool local;
+        int index;
+    };
+
+    // The following are set by the Resolver:
+
+    // the number of slots in a call frame: parameters first, then the locals of the body and all nested blocks, where
+    // blocks that don't overlap share slots
+    std::size_t frameSize = 0;
+
+    // the slots of parameters that are captured by a closure and need to be moved into Cells on entry
+    std::vector<int> cells;
+
+    std::vector<Upvalue> upvalues;
+
+    // the bytecode of the body, if the Compiler compiled it for the VM
+    std::shared_ptr<Chunk> chunk;
+
+    // the body as closures, if the ClosureCompiler compiled it
+    std::shared_ptr<CompiledBody> compiled;
+
+    // the body as a C function, in a program the Transpiler compiled (see transpiler/Runtime.h)
+    const LoxFunction *native = nullptr;
+
     explicit Function(Token_ptr name, std::vector<Token_ptr> &&parameters, std::vector<Statement_ptr> &&body);
     static std::shared_ptr<Function> New(Token_ptr name, std::vector<Token_ptr> &&parameters, std::vector<Statement_ptr> &&body);
 
@@ -125,6 +165,9 @@ struct Return : public Statement {
     Token_ptr keyword;
     Expression_ptr value;
 
+    // the value if it is a call, which the Resolver marks as a tail call: it can reuse the returning call's frame
+    Call *tailCall = nullptr;
+
     explicit Return(Token_ptr keyword, Expression_ptr value);
     static std::shared_ptr<Return> New(Token_ptr keyword, Expression_ptr value);
 
@@ -0,0 +1,59 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "CallSite.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+// every call site created while recording, for the statistics
+static vector<shared_ptr<CallSite>> callSites;
+
+bool CallSite::recording = false;
+
+CallSite::CallSite(Token_ptr paren) : paren{move(paren)} {}
+
+shared_ptr<CallSite> CallSite::New(Token_ptr paren) {
+    auto site = make_shared<CallSite>(move(paren));
+
+    if (recording) {
+        callSites.push_back(site);
+    }
+
+    return site;
+}
+
+void CallSite::update(const Value &callee) {
+    if (callee.is<FunctionObject>()) {
+        pinned = callee.as<FunctionObject>()->declaration;
+        declaration = pinned.lock().get();
+    }
+}
+
+void printCallSites(ostream &out) {
+    vector<const CallSite*> executed;
+
+    for (const auto &site : callSites) {
+        if (site->hits + site->misses > 0) {
+            executed.push_back(site.get());
+        }
+    }
+
+    stable_sort(executed.begin(), executed.end(), [](auto left, auto right) {
+        return left->hits + left->misses > right->hits + right->misses;
+    });
+
+    for (auto site : executed) {
+        out << "[stats] call site at line " << site->paren->line << ": hits " << site->hits << ", misses "
+            << site->misses;
+
+        if (auto declaration = site->pinned.lock()) {
+            out << " (" << declaration->name->lexeme << ")";
+        }
+
+        out << "\n";
+    }
+}
@@ -0,0 +1,63 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_CALLSITE_H
+#define LOX_INTERPRETER_CALLSITE_H
+
+#include "Callable.h"
+#include "data/token.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+/*
+ * A monomorphic inline cache for a call in the source, used by the tree-walking Interpreter and the register VM. It
+ * remembers the declaration of the Lox function called last: all closures of a declaration take the same number of
+ * arguments and run the same code, so calling one of them again needs neither the check that the callee is callable nor
+ * the arity check. Calling anything else is a miss, which checks the callee and caches it instead, if it is a Lox
+ * function.
+ *
+ * With `recording` set, as it is for --stats, call sites are registered when they are created, so that the hits and
+ * misses of each can be reported. Otherwise nothing refers to them but their calls.
+ */
+struct CallSite {
+    // the closing parenthesis of the call
+    Token_ptr paren;
+
+    const Function *declaration = nullptr;
+
+    // Tells whether the cached declaration still exists. Once it is destroyed, a different declaration may be allocated
+    // at the same address, and must not hit. It is weak since the declaration's body may contain this very call.
+    std::weak_ptr<Function> pinned;
+
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+
+    static bool recording;
+
+    explicit CallSite(Token_ptr paren);
+    static std::shared_ptr<CallSite> New(Token_ptr paren);
+
+    // whether the callee is a closure of the cached declaration, counting a hit or a miss
+    bool hit(const Value &callee) {
+        if (callee.is<FunctionObject>() and callee.as<FunctionObject>()->declaration.get() == declaration
+            and not pinned.expired()) {
+            ++hits;
+            return true;
+        }
+
+        ++misses;
+        return false;
+    }
+
+    // caches a callee that missed, once it passed the checks
+    void update(const Value &callee);
+};
+
+// prints the hits and misses of every recorded call site that was executed, most frequent first
+void printCallSites(std::ostream &out);
+
+
+#endif //LOX_INTERPRETER_CALLSITE_H
@@ -6,16 +6,6 @@
 
 using namespace std;
 
-// Deep copy
-
-shared_ptr<LoxObject> Native::clone() const {
-    return make_shared<Native>(*this);
-}
-
-Object_ptr FunctionObject::clone() const {
-    return make_shared<FunctionObject>(*this);
-}
-
 // Printing
 
 ostream& Native::print(ostream &out) const {
@@ -36,30 +26,47 @@ bool Native::equals(const LoxObject &object) const {
 }
 
 bool FunctionObject::equals(const LoxObject &object) const {
-    if (auto other = dynamic_cast<const FunctionObject*>(&object)) {
-        return this->declaration == other->declaration;
-    }
-
+    // closures of the same declaration still capture different variables
     return false;
 }
 
 // Construction
 
 Native::Native(int arity, NativeCallback callback)
-    : _arity{arity}, callback{move(callback)} {}
+    : Callable{Kind::NATIVE}, _arity{arity}, callback{move(callback)} {}
+
+FunctionObject::FunctionObject(shared_ptr<Function> declaration, const Value *frame, const FunctionObject *enclosing)
+    : Callable{Kind::FUNCTION}, declaration{move(declaration)} {
+
+    auto upvalues = const_cast<Cell**>(this->upvalues());
 
-FunctionObject::FunctionObject(shared_ptr<Function> declaration, Environment_ptr closure)
-    : declaration{move(declaration)}, closure{move(closure)} {}
+    for (const auto &upvalue : this->declaration->upvalues) {
+        *upvalues++ = upvalue.local ? frame[upvalue.index].as<Cell>() : enclosing->upvalues()[upvalue.index];
+    }
+}
 
 
 // Factory functions
 
-shared_ptr<Native> Native::New(int arity, NativeCallback callback) {
-    return make_shared<Native>(arity, move(callback));
+Value Native::New(int arity, NativeCallback callback) {
+    return Value::object(Heap::current().allocate<Native>(arity, move(callback)));
 }
 
-shared_ptr<FunctionObject> FunctionObject::New(shared_ptr<Function> declaration, Environment_ptr closure) {
-    return make_shared<FunctionObject>(move(declaration), move(closure));
+Value FunctionObject::New(shared_ptr<Function> declaration, const Value *frame, const FunctionObject *enclosing) {
+    auto size = sizeof(FunctionObject) + declaration->upvalues.size() * sizeof(Cell*);
+    return Value::object(Heap::current().allocateSized<FunctionObject>(size, move(declaration), frame, enclosing));
+}
+
+// Tracing
+
+void Native::trace(Heap &heap) const {
+    // Natives don't refer to other objects
+}
+
+void FunctionObject::trace(Heap &heap) const {
+    for (size_t i = 0; i < declaration->upvalues.size(); ++i) {
+        heap.mark(upvalues()[i]);
+    }
 }
 
 // Arity
@@ -75,26 +82,13 @@ int FunctionObject::arity() const {
 
 // Invocation
 
-Object_ptr Native::call(Interpreter &interpreter, vector<Object_ptr> &arguments) const {
-    return callback(interpreter, arguments);
+Value Native::call(Interpreter &interpreter, size_t arguments) const {
+    return callback(interpreter, interpreter.argumentsAt(arguments));
 }
 
-Object_ptr FunctionObject::call(Interpreter &interpreter, std::vector<Object_ptr> &arguments) const {
-    // can't move here, because we want interpreter to retain its globals
-    auto environment = Environment::New(closure);
-
-    for (int i = 0; i < declaration->parameters.size(); ++i) {
-        auto argument = arguments.at(i);
-        environment->define(declaration->parameters.at(i)->lexeme, move(argument));
-    }
-
-    try {
-        interpreter.executeBlock(declaration->body, move(environment));
-    } catch (const ReturnValue &returnValue) {
-        return move(returnValue.value);
-    }
-
-    return Nil::New();
+Value FunctionObject::call(Interpreter &interpreter, size_t arguments) const {
+    // the arguments become the first slots of the new frame
+    return interpreter.call(*this, arguments);
 }
 
 
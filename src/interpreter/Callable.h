@@ -8,16 +8,25 @@
 #include "LoxObject.h"
 #include "Interpreter.h"
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 
-using NativeCallback = std::function<Object_ptr(Interpreter&, std::vector<Object_ptr>&)>;
+using NativeCallback = std::function<Value(Interpreter&, const Value *arguments)>;
 
 // Anything that can be called in Lox
 class Callable : public LoxObject {
 
+protected:
+    using LoxObject::LoxObject;
+
 public:
-    virtual Object_ptr call(Interpreter &interpreter, std::vector<Object_ptr> &arguments) const = 0;
+    static bool classof(const LoxObject &object) {
+        return object.kind == Kind::NATIVE or object.kind == Kind::FUNCTION;
+    }
+
+    // calls with the arguments the interpreter has left on its stack, starting at the given index
+    virtual Value call(Interpreter &interpreter, std::size_t arguments) const = 0;
     virtual int arity() const = 0;
 };
 
@@ -33,34 +42,56 @@ private:
     bool equals(const LoxObject &object) const override;
 
 public:
+    static bool classof(const LoxObject &object) {
+        return object.kind == Kind::NATIVE;
+    }
+
     explicit Native(int arity, NativeCallback callback);
-    static std::shared_ptr<Native> New(int arity, NativeCallback callback);
+    static Value New(int arity, NativeCallback callback);
 
-    Object_ptr clone() const override;
+    void trace(Heap &heap) const override;
 
     int arity() const override;
-    Object_ptr call(Interpreter &interpreter, std::vector<Object_ptr> &arguments) const override;
+    Value call(Interpreter &interpreter, std::size_t arguments) const override;
+
+    // calls the native directly with arguments stored elsewhere than the interpreter's stack, e.g. by the VM
+    Value invoke(Interpreter &interpreter, const Value *arguments) const {
+        return callback(interpreter, arguments);
+    }
 };
 
-// Functions declared by Users
+// Functions declared by Users, i.e. closures: a declaration and the Cells of the variables it captures, which are stored
+// right behind the object
 class FunctionObject : public Callable {
 
 private:
-    std::shared_ptr<Function> declaration;
-    Environment_ptr closure;
+    explicit FunctionObject(std::shared_ptr<Function> declaration, const Value *frame, const FunctionObject *enclosing);
+    friend class Heap;
 
     std::ostream& print(std::ostream &out) const override;
     bool equals(const LoxObject &object) const override;
 
 public:
-    explicit FunctionObject(std::shared_ptr<Function> declaration, Environment_ptr closure);
-    static std::shared_ptr<FunctionObject> New(std::shared_ptr<Function> declaration, Environment_ptr closure);
+    static bool classof(const LoxObject &object) {
+        return object.kind == Kind::FUNCTION;
+    }
 
-    Object_ptr clone() const override;
+    const std::shared_ptr<Function> declaration;
+
+    // creates a closure over the Cells in the frame of the declaring call and the upvalues of the declaring function
+    static Value New(std::shared_ptr<Function> declaration, const Value *frame, const FunctionObject *enclosing);
+
+    Cell* const* upvalues() const {
+        return reinterpret_cast<Cell* const*>(this + 1);
+    }
+
+    void trace(Heap &heap) const override;
 
     int arity() const override;
-    Object_ptr call(Interpreter &interpreter, std::vector<Object_ptr> &arguments) const override;
+    Value call(Interpreter &interpreter, std::size_t arguments) const override;
 };
 
+static_assert(sizeof(FunctionObject) % alignof(Cell*) == 0, "upvalues must be aligned");
+
 
 #endif //LOX_INTERPRETER_CALLABLE_H
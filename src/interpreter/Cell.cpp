@@ -0,0 +1,41 @@
+//
+// Created by Lucas Wolf on 2019-02-26.
+//
+
+#include "Cell.h"
+
+using namespace std;
+
+// Constructors
+
+Cell::Cell(Value value) : LoxObject{Kind::CELL}, value{value} {}
+
+
+// Factory Functions
+
+Value Cell::New(Value value) {
+    auto &heap = Heap::current();
+    ++heap.cellsAllocated;
+
+    return Value::object(heap.allocate<Cell>(value));
+}
+
+
+// Tracing
+
+void Cell::trace(Heap &heap) const {
+    heap.mark(value);
+}
+
+
+// Printing and equality, only for completeness since Cells are never visible in Lox
+
+ostream& Cell::print(ostream &out) const {
+    out << "<cell>";
+    return out;
+}
+
+bool Cell::equals(const LoxObject &object) const {
+    // distinct Cells are distinct variables
+    return false;
+}
@@ -0,0 +1,49 @@
+//
+// Created by Lucas Wolf on 2019-02-26.
+//
+
+#ifndef LOX_INTERPRETER_CELL_H
+#define LOX_INTERPRETER_CELL_H
+
+#include "interpreter/LoxObject.h"
+#include "interpreter/Heap.h"
+
+
+/*
+ * A local variable that is captured by a closure. Locals normally live in the frame of the call that declares them,
+ * which is gone once the call returns; the Resolver marks the ones nested functions refer to, and those are moved into
+ * a Cell that the frame and all closures share instead. Cells are the only mutable LoxObjects, and never escape into
+ * Lox code: reading the variable yields the Value inside.
+ */
+class Cell : public LoxObject {
+
+public:
+    static bool classof(const LoxObject &object) {
+        return object.kind == Kind::CELL;
+    }
+
+    static Value New(Value value);
+
+    Value get() const {
+        return value;
+    }
+
+    void set(Value value) {
+        Heap::current().writeBarrier(this, value);
+        this->value = value;
+    }
+
+    void trace(Heap &heap) const override;
+
+private:
+    Value value;
+
+    explicit Cell(Value value);
+    friend class Heap;
+
+    std::ostream& print(std::ostream &out) const override;
+    bool equals(const LoxObject &object) const override;
+};
+
+
+#endif //LOX_INTERPRETER_CELL_H
@@ -0,0 +1,82 @@
+//
+// Created by Lucas Wolf on 2019-02-26.
+//
+
+#include "Globals.h"
+
+#include "interpreter/RuntimeError.h"
+
+using namespace std;
+
+// Factory Functions
+
+Globals* Globals::New() {
+    return Heap::current().allocate<Globals>();
+}
+
+
+// Tracing
+
+void Globals::trace(Heap &heap) const {
+    for (const auto &index : indices) {
+        heap.mark(index.first);
+    }
+
+    for (const auto &global : variables) {
+        heap.mark(global.value);
+    }
+}
+
+
+// Global variables
+
+int Globals::bind(const string &name) {
+    auto symbol = String::New(name);
+    auto index = indices.find(symbol);
+
+    if (index != indices.end()) {
+        return index->second;
+    }
+
+    Heap::current().writeBarrier(this, symbol);
+
+    auto next = static_cast<int>(variables.size());
+    indices.emplace(symbol, next);
+    variables.push_back({Value::nil(), false});
+
+    return next;
+}
+
+void Globals::define(const string &name, Value value) {
+    define(bind(name), value);
+}
+
+void Globals::define(int index, Value value) {
+    auto &global = variables[index];
+
+    Heap::current().writeBarrier(this, value);
+    global = {value, true};
+}
+
+void Globals::assign(int index, const Token &name, Value value) {
+    if (not replace(index, value)) {
+        undefined(name);
+    }
+}
+
+bool Globals::replace(int index, Value value) {
+    auto &global = variables[index];
+
+    if (not global.defined) {
+        return false;
+    }
+
+    Heap::current().writeBarrier(this, value);
+    global.value = value;
+
+    return true;
+}
+
+void Globals::undefined(const Token &name) {
+    throw RuntimeError(name, "Undefined variable \'" + name.lexeme + "\'.");
+}
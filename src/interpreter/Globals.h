@@ -0,0 +1,71 @@
+//
+// Created by Lucas Wolf on 2019-02-26.
+//
+
+#ifndef LOX_INTERPRETER_GLOBALS_H
+#define LOX_INTERPRETER_GLOBALS_H
+
+#include "interpreter/LoxObject.h"
+#include "interpreter/Heap.h"
+#include "data/token.h"
+
+#include <unordered_map>
+#include <vector>
+
+
+/*
+ * The global scope. Globals can't be resolved statically (they may be used in a function before they are declared), so
+ * every name is assigned an index into a dense array of variables the first time it is looked up, whether the variable
+ * has been defined by then or not. Accesses bind to that index once and check whether the variable is defined on every
+ * access.
+ */
+class Globals : public HeapObject {
+
+public:
+    static Globals* New();
+
+    // Returns the index of the variable with the given name, reserving one if necessary. Names are interned Strings
+    // once bound, which the Globals keep alive.
+    int bind(const std::string &name);
+
+    // associates a new variable with a name, or with the index bound to the name
+    void define(const std::string &name, Value value);
+    void define(int index, Value value);
+
+    Value get(int index, const Token &name) const {
+        auto &global = variables[index];
+
+        if (not global.defined) {
+            undefined(name);
+        }
+
+        return global.value;
+    }
+
+    // assigns a new value to an existing variable
+    void assign(int index, const Token &name, Value value);
+
+    // like get and assign, but leave reporting undefined variables to the caller: find returns nullptr, replace false
+    const Value* find(int index) const {
+        auto &global = variables[index];
+        return global.defined ? &global.value : nullptr;
+    }
+
+    bool replace(int index, Value value);
+
+    void trace(Heap &heap) const override;
+
+private:
+    struct Global {
+        Value value;
+        bool defined;
+    };
+
+    std::vector<Global> variables;
+    std::unordered_map<Value, int, SymbolHash, SymbolEqual> indices;
+
+    [[noreturn]] static void undefined(const Token &name);
+};
+
+
+#endif //LOX_INTERPRETER_GLOBALS_H
@@ -0,0 +1,434 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "Heap.h"
+
+#include "LoxObject.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+using namespace std::chrono;
+
+Heap *Heap::active = nullptr;
+
+Heap::Heap() : previous{active}, liveObjects(KINDS), liveBytes(KINDS) {
+    for (auto size = GRANULARITY; size <= LARGEST; size += GRANULARITY) {
+        pools.emplace_back(size);
+    }
+
+    active = this;
+}
+
+Heap::~Heap() {
+    // Destroy everything, regardless of reachability. The pools release their memory in bulk afterwards.
+    for (auto generation : {&nursery, &objects, &unswept}) {
+        while (*generation) {
+            auto object = *generation;
+            *generation = object->next;
+
+            auto size = object->size;
+            object->~HeapObject();
+
+            if (size > LARGEST) {
+                ::operator delete(object);
+            }
+        }
+    }
+
+    active = previous;
+}
+
+
+// Allocation
+
+void* Heap::allocateMemory(size_t size) {
+    if (size > LARGEST) {
+        return ::operator new(size);
+    }
+
+    return pools[(size - 1) / GRANULARITY].allocate();
+}
+
+void Heap::release(HeapObject *object) {
+    auto size = object->size;
+
+    if (object->kindIndex != HeapObject::UNCOUNTED) {
+        --liveObjects[object->kindIndex];
+        liveBytes[object->kindIndex] -= size;
+    }
+
+    object->~HeapObject();
+
+    if (size > LARGEST) {
+        ::operator delete(object);
+    } else {
+        pools[(size - 1) / GRANULARITY].free(object);
+    }
+}
+
+void Heap::track(HeapObject *object, size_t size, uint8_t kindIndex) {
+    object->size = static_cast<uint32_t>(size);
+    object->mark = epoch - 1;
+    object->next = nursery;
+    object->kindIndex = kindIndex;
+    nursery = object;
+
+    nurseryBytes += size;
+
+    if (kindIndex != HeapObject::UNCOUNTED) {
+        ++objectsAllocated;
+        ++liveObjects[kindIndex];
+        liveBytes[kindIndex] += size;
+    }
+}
+
+size_t Heap::bytesAllocated() const {
+    return nurseryBytes + oldBytes;
+}
+
+
+// Roots
+
+void Heap::addRoots(RootSet *roots) {
+    this->roots.push_back(roots);
+}
+
+void Heap::removeRoots(RootSet *roots) {
+    this->roots.erase(remove(this->roots.begin(), this->roots.end(), roots), this->roots.end());
+}
+
+void Heap::pin(HeapObject *object) {
+    if (not object->pinned) {
+        object->pinned = true;
+        pinned.push_back(object);
+    }
+}
+
+void Heap::markRoots() {
+    for (auto roots : this->roots) {
+        roots->markRoots(*this);
+    }
+
+    for (auto object : pinned) {
+        mark(object);
+    }
+}
+
+
+// Marking
+
+void Heap::mark(const Value &value) {
+    if (value.isObject()) {
+        mark(value.asObject());
+    }
+}
+
+void Heap::mark(const HeapObject *object) {
+    if (object == nullptr or object->mark == epoch) {
+        return;
+    }
+
+    // minor collections take every old object to be alive
+    if (minor and object->old) {
+        return;
+    }
+
+    object->mark = epoch;
+    (minor ? young : gray).push_back(object);
+}
+
+void Heap::recordWrite(const HeapObject *object, const Value &value) {
+    const HeapObject *target = value.asObject();
+
+    if (not target->old) {
+        // the next minor collection has to trace object, as it may be the only one referring to target
+        if (not object->remembered) {
+            object->remembered = true;
+            remembered.push_back(object);
+        }
+    } else if (phase == Phase::MARKING and object->mark == epoch and target->mark != epoch) {
+        // object may already have been traced, so it is up to us to keep target from being swept
+        target->mark = epoch;
+        gray.push_back(target);
+    }
+}
+
+
+// Collection
+
+void Heap::collect() {
+    collectNursery();
+
+    // Finish the major collection in progress, whose marking may predate the latest garbage, then run a fresh one
+    if (phase != Phase::IDLE) {
+        collectOld({}, false);
+    }
+
+    collectOld({}, false);
+}
+
+void Heap::collectGarbage() {
+    auto start = steady_clock::now();
+    collectNursery();
+
+    auto end = steady_clock::now();
+    minorPauses.record(end - start);
+
+    // Major collections proceed right after minor ones, so they never have to deal with young objects
+    auto limit = max(threshold, minimumThreshold);
+
+    if (phase == Phase::IDLE and not stress and oldBytes <= limit) {
+        return;
+    }
+
+    // An incremental collection that falls too far behind the program finishes at once, so the heap can't outgrow it
+    auto incremental = maxPause.count() > 0 and oldBytes <= 2 * limit;
+
+    collectOld(end + maxPause, incremental);
+    majorPauses.record(steady_clock::now() - end);
+}
+
+void Heap::collectNursery() {
+    // Mark the young objects reachable from the roots, or from old objects that were written references to them
+    minor = true;
+    markRoots();
+
+    for (auto object : remembered) {
+        object->trace(*this);
+    }
+
+    while (not young.empty()) {
+        auto object = young.back();
+        young.pop_back();
+
+        object->trace(*this);
+    }
+
+    minor = false;
+
+    // Promote the marked ones, free the others
+    while (nursery) {
+        auto object = nursery;
+        nursery = object->next;
+
+        if (object->mark == epoch) {
+            object->old = true;
+            object->next = objects;
+            objects = object;
+
+            oldBytes += object->size;
+            ++objectsPromoted;
+
+            // survivors are marked, so a major collection in progress still has to trace them
+            if (phase == Phase::MARKING) {
+                gray.push_back(object);
+            }
+        } else {
+            ++objectsFreed;
+            release(object);
+        }
+    }
+
+    nurseryBytes = 0;
+
+    for (auto object : remembered) {
+        object->remembered = false;
+    }
+
+    remembered.clear();
+    ++minorCollections;
+}
+
+
+// Major collections
+
+void Heap::collectOld(Deadline deadline, bool incremental) {
+    if (phase == Phase::IDLE) {
+        startMarking();
+    }
+
+    if (phase == Phase::MARKING and markOld(deadline, incremental)) {
+        finishMarking();
+    }
+
+    if (phase == Phase::SWEEPING and sweepOld(deadline, incremental)) {
+        finishSweeping();
+    }
+}
+
+bool Heap::exceeds(Deadline deadline, size_t work) const {
+    // Reading the clock is comparatively expensive, so only do so every once in a while. Under stress, do as little
+    // as possible per step instead, to interleave the collection with the program as finely as possible.
+    if (stress) {
+        return work > 1;
+    }
+
+    return work % 64 == 0 and steady_clock::now() >= deadline;
+}
+
+void Heap::startMarking() {
+    // Advancing the epoch unmarks all objects at once
+    ++epoch;
+    phase = Phase::MARKING;
+
+    markRoots();
+}
+
+bool Heap::markOld(Deadline deadline, bool incremental) {
+    size_t work = 0;
+
+    while (not gray.empty()) {
+        if (incremental and exceeds(deadline, ++work)) {
+            return false;
+        }
+
+        auto object = gray.back();
+        gray.pop_back();
+
+        object->trace(*this);
+    }
+
+    return true;
+}
+
+void Heap::finishMarking() {
+    // The roots aren't covered by the write barrier, so mark them once more. This step can't be interrupted, but
+    // usually only finds little that isn't marked yet.
+    markRoots();
+    markOld({}, false);
+
+    unswept = objects;
+    objects = nullptr;
+    phase = Phase::SWEEPING;
+}
+
+bool Heap::sweepOld(Deadline deadline, bool incremental) {
+    size_t work = 0;
+
+    while (unswept) {
+        if (incremental and exceeds(deadline, ++work)) {
+            return false;
+        }
+
+        auto object = unswept;
+        unswept = object->next;
+
+        if (object->mark == epoch) {
+            object->next = objects;
+            objects = object;
+        } else {
+            oldBytes -= object->size;
+            ++objectsFreed;
+
+            release(object);
+        }
+    }
+
+    return true;
+}
+
+void Heap::finishSweeping() {
+    phase = Phase::IDLE;
+    threshold = static_cast<size_t>(oldBytes * growth);
+
+    ++majorCollections;
+}
+
+
+// String interning
+
+String* Heap::findString(string_view value) {
+    auto entry = strings.find(value);
+
+    if (entry == strings.end()) {
+        return nullptr;
+    }
+
+    auto string = entry->second;
+
+    // The String may be unreachable as far as the major collection in progress is concerned, but it is about to be
+    // handed out again. Unmarked old Strings that still exist while sweeping are yet to be swept.
+    if (phase != Phase::IDLE and string->old and string->mark != epoch) {
+        string->mark = epoch;
+
+        if (phase == Phase::MARKING) {
+            gray.push_back(string);
+        }
+    }
+
+    return string;
+}
+
+void Heap::addString(String *string) {
+    strings.emplace(string->value(), string);
+}
+
+void Heap::removeString(const String *string) {
+    auto entry = strings.find(string->value());
+
+    if (entry != strings.end() and entry->second == string) {
+        strings.erase(entry);
+    }
+}
+
+
+// Statistics
+
+void PauseHistogram::record(nanoseconds pause) {
+    size_t bucket = 0;
+
+    for (auto limit = microseconds{10}; bucket < BUCKETS - 1 and pause >= limit; limit *= 10) {
+        ++bucket;
+    }
+
+    ++counts[bucket];
+    total += pause;
+    longest = max(longest, pause);
+}
+
+void PauseHistogram::print(ostream &out, string_view name) const {
+    static const char *labels[BUCKETS] = {"<10us", "<100us", "<1ms", "<10ms", "<100ms", ">=100ms"};
+
+    out << "[stats] " << name << " pauses:";
+
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        out << (bucket ? ", " : " ") << labels[bucket] << " " << counts[bucket];
+    }
+
+    out << fixed << setprecision(3)
+        << " (total " << duration<double, milli>(total).count() << " ms"
+        << ", longest " << duration<double, milli>(longest).count() << " ms)\n"
+        << defaultfloat;
+}
+
+void Heap::printStatistics(ostream &out) const {
+    out << "[stats] objects allocated: " << objectsAllocated << "\n";
+    out << "[stats] cells allocated: " << cellsAllocated << "\n";
+    out << "[stats] minor collections: " << minorCollections << "\n";
+    out << "[stats] major collections: " << majorCollections << "\n";
+    out << "[stats] objects promoted: " << objectsPromoted << "\n";
+    out << "[stats] objects freed: " << objectsFreed << "\n";
+    out << "[stats] bytes live: " << bytesAllocated() << "\n";
+
+    static const char *kinds[KINDS] = {"nil", "boolean", "number", "String", "Native", "FunctionObject", "Cell"};
+
+    for (size_t kind = 0; kind < KINDS; ++kind) {
+        if (liveObjects[kind] > 0) {
+            out << "[stats] " << kinds[kind] << ": " << liveObjects[kind] << " live, " << liveBytes[kind] << " B\n";
+        }
+    }
+
+    for (const auto &pool : pools) {
+        if (pool.bytes() > 0) {
+            out << "[stats] pool " << pool.slotSize() << " B: " << pool.live() << " live, "
+                << pool.bytes() / 1024 << " KiB\n";
+        }
+    }
+
+    minorPauses.print(out, "minor");
+    majorPauses.print(out, "major");
+}
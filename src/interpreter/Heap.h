@@ -0,0 +1,275 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_HEAP_H
+#define LOX_INTERPRETER_HEAP_H
+
+#include "Value.h"
+#include "Pool.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Forward declarations
+class Heap;
+struct LoxObject;
+struct String;
+
+
+/*
+ * Base class of everything the garbage collector manages, i.e. all LoxObjects and the Globals.
+ */
+struct HeapObject {
+
+public:
+    virtual ~HeapObject() = default;
+
+    // marks all heap objects this object refers to
+    virtual void trace(Heap &heap) const = 0;
+
+private:
+    friend class Heap;
+
+    // each generation forms an intrusive list, which the sweep phases walk
+    HeapObject *next = nullptr;
+
+    std::uint32_t size = 0;
+
+    // an object is marked iff this equals the heap's current epoch, so marks never need to be cleared
+    mutable std::uint32_t mark = 0;
+
+    bool old = false;
+    mutable bool remembered = false;
+    bool pinned = false;
+
+    // the Kind of a LoxObject, under which the heap counts it as live, or UNCOUNTED for other heap objects
+    static constexpr std::uint8_t UNCOUNTED = 0xff;
+    std::uint8_t kindIndex = UNCOUNTED;
+};
+
+
+// Anything outside of the heap that holds references into it, e.g. the Interpreter
+class RootSet {
+
+public:
+    virtual void markRoots(Heap &heap) = 0;
+
+protected:
+    // root sets are never owned through this interface
+    ~RootSet() = default;
+};
+
+
+// Distribution of pause times, in power-of-ten buckets from "below 10µs" to "100ms and above"
+struct PauseHistogram {
+    static constexpr std::size_t BUCKETS = 6;
+
+    std::array<std::size_t, BUCKETS> counts {};
+    std::chrono::nanoseconds total {0};
+    std::chrono::nanoseconds longest {0};
+
+    void record(std::chrono::nanoseconds pause);
+    void print(std::ostream &out, std::string_view name) const;
+};
+
+
+/*
+ * A generational, non-moving garbage collector that owns all heap objects.
+ *
+ * New objects are allocated into the nursery. Once it holds more than `nurserySize` bytes, a minor collection traces
+ * the young objects reachable from the roots and from the remembered set (old objects that were handed a reference to
+ * a young one, see writeBarrier), frees the others and promotes the survivors to the old generation. Promotion happens
+ * in place rather than by copying, since objects are referenced by raw pointers from native frames, the syntax tree
+ * and the string table.
+ *
+ * Once the old generation exceeds a threshold, a major collection marks and sweeps it. Afterwards, the threshold is set
+ * to `growth` times the size of the surviving old generation, but never below `minimumThreshold`. If `maxPause` is
+ * non-zero, major collections are incremental: after each minor collection, marking or sweeping proceeds for at most
+ * `maxPause`, and the write barrier keeps the marking consistent while the program runs in between. Otherwise, major
+ * collections stop the world.
+ *
+ * Objects are allocated from Pools, one per size class of GRANULARITY bytes, so that every kind of object is served
+ * from a pool of slots that (nearly) fit it exactly. Freed slots are reused by objects of the same size class, and all
+ * slabs are released at once when the Heap is destroyed. The size classes are generic rather than one per LoxObject
+ * subclass, since Strings and Natives vary in size; the statistics count live objects both by pool and by Kind.
+ *
+ * Whoever holds references to heap objects across an allocation must make them reachable from a RootSet, and whoever
+ * stores a reference into an existing heap object must call writeBarrier.
+ */
+class Heap {
+
+public:
+    // Objects are rounded up to multiples of GRANULARITY bytes. Objects larger than LARGEST bytes aren't pooled.
+    static constexpr std::size_t GRANULARITY = 16;
+    static constexpr std::size_t LARGEST = 256;
+
+    // Tunables
+    std::size_t nurserySize = 256 * 1024;
+    std::size_t minimumThreshold = 1024 * 1024;
+    double growth = 2.0;
+    std::chrono::microseconds maxPause {0};
+
+    // collect before every allocation and interleave major collections with the program as finely as possible, to
+    // flush out missing roots and write barriers
+    bool stress = false;
+
+    // Statistics
+    std::size_t objectsAllocated = 0;
+    std::size_t cellsAllocated = 0;
+    std::size_t minorCollections = 0;
+    std::size_t majorCollections = 0;
+    std::size_t objectsPromoted = 0;
+    std::size_t objectsFreed = 0;
+    PauseHistogram minorPauses;
+    PauseHistogram majorPauses;
+
+    Heap();
+    ~Heap();
+
+    Heap(const Heap&) = delete;
+    Heap& operator=(const Heap&) = delete;
+
+    // the most recently created heap that is still alive, into which all objects are allocated
+    static Heap& current() {
+        return *active;
+    }
+
+    template<typename T, typename... Arguments>
+    T* allocate(Arguments&&... arguments) {
+        return allocateSized<T>(sizeof(T), std::forward<Arguments>(arguments)...);
+    }
+
+    // allocates an object that occupies `size` bytes, i.e. sizeof(T) followed by storage that T manages itself
+    template<typename T, typename... Arguments>
+    T* allocateSized(std::size_t size, Arguments&&... arguments);
+
+    // collects both generations completely, stopping the world
+    void collect();
+
+    void addRoots(RootSet *roots);
+    void removeRoots(RootSet *roots);
+
+    // keeps an object alive regardless of whether it is reachable, e.g. for names referenced by the syntax tree
+    void pin(HeapObject *object);
+
+    // must be called whenever value is stored into object after its construction
+    void writeBarrier(const HeapObject *object, const Value &value) {
+        if (object->old and value.isObject()) {
+            recordWrite(object, value);
+        }
+    }
+
+    // Marking, used by RootSets and HeapObject::trace
+    void mark(const Value &value);
+    void mark(const HeapObject *object);
+
+    // Interned Strings. The table does not keep its Strings alive.
+    String* findString(std::string_view value);
+    void addString(String *string);
+    void removeString(const String *string);
+
+    std::size_t bytesAllocated() const;
+    void printStatistics(std::ostream &out) const;
+
+    // the pools objects are allocated from, by ascending slot size
+    const std::vector<Pool>& sizeClasses() const {
+        return pools;
+    }
+
+private:
+    enum class Phase {
+        IDLE, MARKING, SWEEPING
+    };
+
+    static Heap *active;
+    Heap *previous;
+
+    // the young generation, and the old generation as far as it has been swept (or promoted since)
+    HeapObject *nursery = nullptr;
+    HeapObject *objects = nullptr;
+
+    // old objects the current major collection has yet to sweep
+    HeapObject *unswept = nullptr;
+
+    std::size_t nurseryBytes = 0;
+    std::size_t oldBytes = 0;
+
+    // growth times the size of the old generation after the last major collection
+    std::size_t threshold = 0;
+
+    Phase phase = Phase::IDLE;
+    std::uint32_t epoch = 1;
+
+    // whether mark() currently serves a minor collection rather than a major one
+    bool minor = false;
+
+    std::vector<RootSet*> roots;
+    std::vector<HeapObject*> pinned;
+    std::vector<const HeapObject*> remembered;
+
+    // marked objects whose references have yet to be traced, by generation
+    std::vector<const HeapObject*> young;
+    std::vector<const HeapObject*> gray;
+
+    std::unordered_map<std::string_view, String*> strings;
+
+    std::vector<Pool> pools;
+
+    // the LoxObjects currently allocated and the bytes they occupy, indexed by Kind
+    std::vector<std::size_t> liveObjects;
+    std::vector<std::size_t> liveBytes;
+
+    void* allocateMemory(std::size_t size);
+
+    // destroys object and returns its memory to its pool
+    void release(HeapObject *object);
+
+    void track(HeapObject *object, std::size_t size, std::uint8_t kindIndex);
+    void recordWrite(const HeapObject *object, const Value &value);
+
+    void collectGarbage();
+    void collectNursery();
+    void markRoots();
+
+    // Major collections
+    using Deadline = std::chrono::steady_clock::time_point;
+
+    // advances the major collection in progress, or starts a new one, until it is done or the deadline has passed
+    void collectOld(Deadline deadline, bool incremental);
+    bool exceeds(Deadline deadline, std::size_t work) const;
+
+    void startMarking();
+    bool markOld(Deadline deadline, bool incremental);
+    void finishMarking();
+    bool sweepOld(Deadline deadline, bool incremental);
+    void finishSweeping();
+};
+
+
+template<typename T, typename... Arguments>
+T* Heap::allocateSized(std::size_t size, Arguments&&... arguments) {
+    if (stress or nurseryBytes > nurserySize) {
+        collectGarbage();
+    }
+
+    auto object = new (allocateMemory(size)) T(std::forward<Arguments>(arguments)...);
+
+    if constexpr (std::is_base_of<LoxObject, T>::value) {
+        track(object, size, static_cast<std::uint8_t>(object->kind));
+    } else {
+        track(object, size, HeapObject::UNCOUNTED);
+    }
+
+    return object;
+}
+
+#endif //LOX_INTERPRETER_HEAP_H
@@ -6,80 +6,184 @@
 #include "RuntimeError.h"
 #include "LoxObject.h"
 #include "Callable.h"
+#include "CallSite.h"
 
 #include <vector>
+#include <array>
 #include <chrono>
 
 using namespace std;
 
-Interpreter::Interpreter() : globals{move(make_unique<Environment>())} {
+static Value add(const Value &left, const Value &right) {
+    return Value::number(left.asNumber() + right.asNumber());
+}
+
+static Value concatenate(const Value &left, const Value &right) {
+    return String::concatenate(*left.as<String>(), *right.as<String>());
+}
+
+const array<array<PlusHandler, KINDS>, KINDS> plusHandlers = [] {
+    array<array<PlusHandler, KINDS>, KINDS> table {};
+
+    table[size_t(Kind::NUMBER)][size_t(Kind::NUMBER)] = add;
+    table[size_t(Kind::STRING)][size_t(Kind::STRING)] = concatenate;
+
+    return table;
+}();
+
+string plusError(const Value &left) {
+    switch (kindOf(left)) {
+        case Kind::NUMBER:
+            return "Operands of arithmetic operation (+, -, *, /) must be of type Number.";
+
+        case Kind::STRING:
+            return "Operands of string concatenation (+) must be of type String.";
+
+        default:
+            return "Operands of \"+\" must either be both of type Number (addition) or String (concatenation).";
+    }
+}
 
-    environment = globals;
+Interpreter::Interpreter() : globals{Globals::New()} {
+
+    heap.addRoots(this);
 
     // Define native functions
 
-    auto clock = make_shared<Native>(0, [](Interpreter &interpreter, vector<Object_ptr> &arguments){
+    auto clock = Native::New(0, [](Interpreter &interpreter, const Value *arguments){
         auto now = chrono::system_clock::now();
         auto since = chrono::duration_cast<chrono::seconds>(now.time_since_epoch());
 
-        return Number::New(since.count());
+        return Value::number(since.count());
     });
 
 
     globals->define("clock", clock);
 }
 
-void Interpreter::interpret(const vector<Statement_ptr> &statements) {
-    for (auto &statement : statements) {
-        execute(*statement);
-    }
+void Interpreter::interpret(const vector<Statement_ptr> &statements, size_t slots) {
+    // discard frames and temporaries left behind by a runtime error in a previous run
+    stack.clear();
+    stack.resize(slots);
+
+    frame = 0;
+    function = nullptr;
+    completion = Completion::NORMAL;
+
+    execute(statements);
 }
 
 void Interpreter::execute(Statement &statement) {
     statement.accept(*this);
 }
 
+void Interpreter::execute(const vector<Statement_ptr> &statements) {
+    for (const auto &statement : statements) {
+        execute(*statement);
+
+        if (completion != Completion::NORMAL) {
+            return;
+        }
+    }
+}
+
 void Interpreter::visit(ExpressionStatement &statement) {
     evaluate(*statement.expression);
 }
 
 void Interpreter::visit(Block &statement) {
-    executeBlock(statement.statements, make_shared<Environment>(this->environment));
+    // the block's variables have their own slots in the current frame
+    execute(statement.statements);
 }
 
-void Interpreter::executeBlock(const std::vector<Statement_ptr> &statements, Environment_ptr environment) {
-    // retain current environment
-    auto previous = this->environment;
+Value Interpreter::call(const FunctionObject &callee, size_t arguments) {
+    // retain the caller's frame
+    auto previousFrame = frame;
+    auto previousFunction = function;
+
+    frame = arguments;
+    function = &callee;
 
     try {
-        // switch to new environment
-        this->environment = move(environment);
+        // tail calls run in the same frame, one after another
+        while (true) {
+            auto &declaration = *function->declaration;
+            stack.resize(frame + declaration.frameSize);
+
+            // captured parameters move into Cells before the body can create closures over them
+            for (auto slot : declaration.cells) {
+                local(slot) = Cell::New(local(slot));
+            }
+
+            execute(declaration.body);
+
+            if (completion != Completion::TAIL_CALL) {
+                break;
+            }
 
-        // execute block statements in new environment
-        for (const auto &s : statements) {
-            execute(*s);
+            completion = Completion::NORMAL;
+            function = stack[frame - 1].as<FunctionObject>();
         }
 
-    } catch(...) {
-        // Restore the old environment
-        this->environment = previous;
+    } catch (...) {
+        frame = previousFrame;
+        function = previousFunction;
         throw;
     }
 
-    // TODO better, finally-like solution?
+    frame = previousFrame;
+    function = previousFunction;
+
+    if (completion == Completion::RETURN) {
+        completion = Completion::NORMAL;
+        return temporary;
+    }
+
+    // falling off the end of the body returns nil
+    return Value::nil();
+}
+
+void Interpreter::define(Access access, int slot, const Token &name, Value value) {
+    switch (access) {
+        case Access::GLOBAL:
+            globals->define(name.lexeme, value);
+            break;
+
+        case Access::LOCAL:
+            local(slot) = value;
+            break;
+
+        case Access::CELL:
+            // a new Cell on every execution, so closures created in different iterations of a loop don't share it
+            local(slot) = Cell::New(value);
+            break;
+
+        case Access::UPVALUE: ; // Unreachable, declarations are never upvalues
+    }
+}
+
+int Interpreter::bind(int &global, const Token &name) {
+    if (global == UNBOUND) {
+        global = globals->bind(name.lexeme);
+    }
 
-    // Restore the old environment
-    this->environment = previous;
+    return global;
 }
 
-void Interpreter::resolve(Expression &expression, int depth) {
-    locals[&expression] = depth;
+void Interpreter::markRoots(Heap &heap) {
+    heap.mark(globals);
+    heap.mark(temporary);
+    heap.mark(function);
+
+    for (const auto &value : stack) {
+        heap.mark(value);
+    }
 }
 
 
 void Interpreter::visit(Print &statement) {
     evaluate(*statement.expression);
-    cout << *temporary << "\n";
+    cout << temporary << "\n";
 }
 
 void Interpreter::visit(Var &statement) {
@@ -87,17 +191,16 @@ void Interpreter::visit(Var &statement) {
     if (statement.initializer) {
         evaluate(*statement.initializer);
     } else {
-        temporary = Nil::New();
+        temporary = Value::nil();
     }
 
-    // copies shared_ptr
-    environment->define(statement.name->lexeme, temporary);
+    define(statement.access, statement.slot, *statement.name, temporary);
 }
 
 void Interpreter::visit(If &statement) {
     evaluate(*statement.condition);
 
-    if (temporary->isTruthy()) {
+    if (temporary.isTruthy()) {
         execute(*statement.thenBranch);
     } else if (statement.elseBranch) {
         execute(*statement.elseBranch);
@@ -107,61 +210,108 @@ void Interpreter::visit(If &statement) {
 void Interpreter::visit(While &statement) {
     evaluate(*statement.condition);
 
-    while (temporary->isTruthy()) {
+    while (temporary.isTruthy()) {
         execute(*statement.body);
+
+        if (completion != Completion::NORMAL) {
+            return;
+        }
+
         evaluate(*statement.condition);
     }
 }
 
 
 void Interpreter::visit(Function &statement) {
-    // copying the vector should invoke copy constructors of its elements (ie. Token_ptr = shared_ptr<Token>), thus
-    // creating new owning pointers that ensure that these things live beyond parsing
-    vector<Token_ptr> parameters = statement.parameters;
-    vector<Statement_ptr> body = statement.body;
-
-    auto function = Function::New(statement.name, move(parameters), move(body));
-    environment->define(statement.name->lexeme, FunctionObject::New(move(function), environment));
+    // A function that refers to itself captures its own variable, so the Cell has to exist before the closure.
+    // Sharing the declaration keeps the syntax tree of the body alive as long as the function.
+    if (statement.access == Access::CELL) {
+        local(statement.slot) = Cell::New(Value::nil());
+        temporary = FunctionObject::New(statement.shared_from_this(), stack.data() + frame, function);
+        local(statement.slot).as<Cell>()->set(temporary);
+    } else {
+        temporary = FunctionObject::New(statement.shared_from_this(), stack.data() + frame, function);
+        define(statement.access, statement.slot, *statement.name, temporary);
+    }
 }
 
 
 void Interpreter::visit(Return &statement) {
 
-    if (statement.value) {
+    if (statement.tailCall) {
+        auto base = stack.size();
+        auto &callable = push(*statement.tailCall);
+
+        if (FunctionObject::classof(callable)) {
+            // the callee and its arguments take the place of the current function and its frame
+            move(stack.begin() + base, stack.end(), stack.begin() + frame - 1);
+            stack.resize(frame + callable.arity());
+
+            completion = Completion::TAIL_CALL;
+            return;
+        }
+
+        temporary = callable.call(*this, base + 1);
+        stack.resize(base);
+    } else if (statement.value) {
         evaluate(*statement.value);
-        throw ReturnValue {move(temporary)};
+    } else {
+        temporary = Value::nil();
     }
 
-    throw ReturnValue{};
+    completion = Completion::RETURN;
 }
 
 
 void Interpreter::visit(Call &expression) {
+    // callee and arguments stay on the stack (and thus alive) until the call returns
+    auto base = stack.size();
+    auto &callable = push(expression);
+
+    if (FunctionObject::classof(callable)) {
+        temporary = call(static_cast<const FunctionObject&>(callable), base + 1);
+    } else {
+        temporary = callable.call(*this, base + 1);
+    }
+
+    stack.resize(base);
+}
+
+const Callable& Interpreter::push(Call &expression) {
+    auto base = stack.size();
+
     evaluate(*expression.callee);
     auto callee = temporary;
-
-    vector<Object_ptr> arguments;
+    stack.push_back(callee);
 
     // evaluate arguments to call
     for (const auto &argument : expression.arguments) {
         evaluate(*argument);
-        arguments.push_back(temporary);
+        stack.push_back(temporary);
     }
 
-    auto callable = dynamic_cast<Callable*>(callee.get());
+    auto &site = *expression.site;
+
+    if (site.hit(callee)) {
+        return *callee.as<FunctionObject>();
+    }
+
+    auto arguments = stack.size() - base - 1;
+    auto callable = callee.is<Callable>() ? callee.as<Callable>() : nullptr;
 
     if (not callable) {
         throw RuntimeError(*expression.paren, "Can only call functions and classes.");
     }
 
-    if (arguments.size() != callable->arity()) {
+    if (arguments != size_t(callable->arity())) {
         throw RuntimeError(
             *expression.paren,
-            "Expected " + to_string(callable->arity()) + " arguments but got " + to_string(arguments.size()) + "."
+            "Expected " + to_string(callable->arity()) + " arguments but got " + to_string(arguments) + "."
         );
     }
 
-    temporary = callable->call(*this, arguments);
+    site.update(callee);
+    return *callable;
 }
 
 void Interpreter::visit(Unary &expression) {
@@ -173,19 +323,17 @@ void Interpreter::visit(Unary &expression) {
 
         // Unary minus (-)
         case TokenType::MINUS: {
-            auto number = dynamic_cast<Number*>(temporary.get());
-
-            if (not number) {
+            if (not temporary.isNumber()) {
                 throw RuntimeError(token, "Operand of unary minus (-) must be of type Number.");
             }
 
-            number->value = -(number->value);
+            temporary = Value::number(-temporary.asNumber());
             break;
         }
 
         // Logical negation (!)
         case TokenType::BANG: {
-            temporary = Boolean::New(temporary->isTruthy());
+            temporary = Value::boolean(not temporary.isTruthy());
             break;
         }
 
@@ -195,162 +343,315 @@ void Interpreter::visit(Unary &expression) {
 
 void Interpreter::visit(Binary &expression) {
 
-    // Evaluate left and right-hand operands
+    // Evaluate left and right-hand operands. Only objects need to be kept reachable while the right one is evaluated.
 
     evaluate(*expression.left);
     auto left = temporary;
+    auto pushed = left.isObject();
+
+    if (pushed) {
+        stack.push_back(left);
+    }
 
     evaluate(*expression.right);
     auto right = temporary;
 
+    if (not specialized(expression, left, right)) {
+        generic(expression, left, right);
+    }
+
+    if (pushed) {
+        stack.pop_back();
+    }
+}
+
+bool Interpreter::specialized(Binary &expression, const Value &left, const Value &right) {
+    using Specialization = Binary::Specialization;
+
+    auto numbers = left.isNumber() and right.isNumber();
+
+    switch (expression.specialization) {
+        case Specialization::ADD:
+            if (not numbers) {
+                break;
+            }
+
+            temporary = Value::number(left.asNumber() + right.asNumber());
+            return true;
+
+        case Specialization::SUBTRACT:
+            if (not numbers) {
+                break;
+            }
+
+            temporary = Value::number(left.asNumber() - right.asNumber());
+            return true;
+
+        case Specialization::MULTIPLY:
+            if (not numbers) {
+                break;
+            }
+
+            temporary = Value::number(left.asNumber() * right.asNumber());
+            return true;
+
+        case Specialization::DIVIDE:
+            if (not numbers) {
+                break;
+            }
+
+            temporary = Value::number(left.asNumber() / right.asNumber());
+            return true;
+
+        case Specialization::GREATER:
+            if (not numbers) {
+                break;
+            }
+
+            temporary = Value::boolean(left.asNumber() > right.asNumber());
+            return true;
+
+        case Specialization::GREATER_EQUAL:
+            if (not numbers) {
+                break;
+            }
+
+            temporary = Value::boolean(left.asNumber() >= right.asNumber());
+            return true;
+
+        case Specialization::LESS:
+            if (not numbers) {
+                break;
+            }
+
+            temporary = Value::boolean(left.asNumber() < right.asNumber());
+            return true;
+
+        case Specialization::LESS_EQUAL:
+            if (not numbers) {
+                break;
+            }
+
+            temporary = Value::boolean(left.asNumber() <= right.asNumber());
+            return true;
+
+        case Specialization::CONCATENATE:
+            if (not (left.is<String>() and right.is<String>())) {
+                break;
+            }
+
+            temporary = String::concatenate(*left.as<String>(), *right.as<String>());
+            return true;
+
+        case Specialization::EQUAL:
+            temporary = Value::boolean(left == right);
+            return true;
+
+        case Specialization::NOT_EQUAL:
+            temporary = Value::boolean(left != right);
+            return true;
+
+        case Specialization::UNINITIALIZED:
+        case Specialization::GENERIC:
+            return false;
+    }
+
+    // the guard failed
+    expression.specialization = Specialization::GENERIC;
+    return false;
+}
+
+void Interpreter::generic(Binary &expression, const Value &left, const Value &right) {
     const Token &token = *expression.token;
 
     switch(token.type) {
 
         case TokenType::MINUS: {
-            arithmetic(*left, *right, [](auto left, auto right) { return left - right;}, token);
+            arithmetic(left, right, [](auto left, auto right) { return left - right;}, token);
             break;
         }
 
         case TokenType::SLASH: {
-            arithmetic(*left, *right, [](auto left, auto right) { return left / right;}, token);
+            arithmetic(left, right, [](auto left, auto right) { return left / right;}, token);
             break;
         }
 
         case TokenType::STAR: {
-            arithmetic(*left, *right, [](auto left, auto right) { return left * right;}, token);
+            arithmetic(left, right, [](auto left, auto right) { return left * right;}, token);
             break;
         }
 
         case TokenType::PLUS: {
-            if (dynamic_cast<const Number*>(left.get())) {
-                arithmetic(*left, *right, [](auto left, auto right) { return left + right; }, token);
-
-            } else if (auto left_ptr = dynamic_cast<const String*>(left.get())) {
-                auto right_ptr = dynamic_cast<const String*>(right.get());
-
-                if (!right_ptr) {
-                    throw RuntimeError(token, "Operands of string concatenation (+) must be of type String.");
-                }
+            auto handler = plusHandlers[size_t(kindOf(left))][size_t(kindOf(right))];
 
-                temporary = String::New(left_ptr->value + right_ptr->value);
-
-            } else {
-                throw RuntimeError(token, "Operands of \"+\" must either be both of type Number (addition) or String (concatenation).");
+            if (not handler) {
+                throw RuntimeError(token, plusError(left));
             }
 
+            temporary = handler(left, right);
+
             break;
         }
 
         case TokenType::GREATER: {
-            comparison(*left, *right, [](auto left, auto right) { return left > right;}, token);
+            comparison(left, right, [](auto left, auto right) { return left > right;}, token);
             break;
         }
 
         case TokenType::GREATER_EQUAL: {
-            comparison(*left, *right, [](auto left, auto right) { return left >= right;}, token);
+            comparison(left, right, [](auto left, auto right) { return left >= right;}, token);
             break;
         }
 
         case TokenType::LESS: {
-            comparison(*left, *right, [](auto left, auto right) { return left < right;}, token);
+            comparison(left, right, [](auto left, auto right) { return left < right;}, token);
             break;
         }
 
         case TokenType::LESS_EQUAL: {
-            comparison(*left, *right, [](auto left, auto right) { return left <= right;}, token);
+            comparison(left, right, [](auto left, auto right) { return left <= right;}, token);
             break;
         }
 
         case TokenType::BANG_EQUAL: {
-            temporary = Boolean::New(*left != *right);
+            temporary = Value::boolean(left != right);
             break;
         }
 
         case TokenType::EQUAL_EQUAL: {
-            temporary = Boolean::New(*left == *right);
+            temporary = Value::boolean(left == right);
             break;
         }
 
         default: ; // Unreachable
     }
-}
 
-void Interpreter::arithmetic(const LoxObject &left, const LoxObject &right, const Arithmetic &op, const Token &token) {
-    auto left_ptr = dynamic_cast<const Number*>(&left);
-    auto right_ptr = dynamic_cast<const Number*>(&right);
 
-    if (!(left_ptr && right_ptr)) {
-        throw RuntimeError(token, "Operands of arithmetic operation (+, -, *, /) must be of type Number.");
+    if (expression.specialization != Binary::Specialization::UNINITIALIZED) {
+        return;
     }
 
-    auto result = op(left_ptr->value, right_ptr->value);
-    temporary = Number::New(result);
-}
+    // the operation succeeded, so the operands have the types it expects, if any
+    using Specialization = Binary::Specialization;
+    auto numbers = left.isNumber() and right.isNumber();
+
+    switch (token.type) {
+        case TokenType::PLUS:
+            expression.specialization = numbers ? Specialization::ADD : Specialization::CONCATENATE;
+            break;
 
+        case TokenType::MINUS:
+            expression.specialization = Specialization::SUBTRACT;
+            break;
 
-void Interpreter::comparison(const LoxObject &left, const LoxObject &right, const Comparison &op, const Token &token) {
-    auto left_ptr = dynamic_cast<const Number*>(&left);
-    auto right_ptr = dynamic_cast<const Number*>(&right);
+        case TokenType::STAR:
+            expression.specialization = Specialization::MULTIPLY;
+            break;
 
-    if (!(left_ptr && right_ptr)) {
-        throw RuntimeError(token, "Operands of arithmetic comparison (>, >=, <, <=) must be of type Number.");
+        case TokenType::SLASH:
+            expression.specialization = Specialization::DIVIDE;
+            break;
+
+        case TokenType::GREATER:
+            expression.specialization = Specialization::GREATER;
+            break;
+
+        case TokenType::GREATER_EQUAL:
+            expression.specialization = Specialization::GREATER_EQUAL;
+            break;
+
+        case TokenType::LESS:
+            expression.specialization = Specialization::LESS;
+            break;
+
+        case TokenType::LESS_EQUAL:
+            expression.specialization = Specialization::LESS_EQUAL;
+            break;
+
+        case TokenType::EQUAL_EQUAL:
+            expression.specialization = Specialization::EQUAL;
+            break;
+
+        case TokenType::BANG_EQUAL:
+            expression.specialization = Specialization::NOT_EQUAL;
+            break;
+
+        default: ; // Unreachable
+    }
+}
+
+template<typename Operation>
+void Interpreter::arithmetic(const Value &left, const Value &right, Operation op, const Token &token) {
+    if (!(left.isNumber() && right.isNumber())) {
+        throw RuntimeError(token, "Operands of arithmetic operation (+, -, *, /) must be of type Number.");
     }
 
-    auto result = op(left_ptr->value, right_ptr->value);
-    temporary = Boolean::New(result);
+    auto result = op(left.asNumber(), right.asNumber());
+    temporary = Value::number(result);
 }
 
-const Number* asNumber(const LoxObject &object) {
-    if (auto number = dynamic_cast<const Number*>(&object)) {
-        return number;
-    } else {
-        return nullptr;
+
+template<typename Operation>
+void Interpreter::comparison(const Value &left, const Value &right, Operation op, const Token &token) {
+    if (!(left.isNumber() && right.isNumber())) {
+        throw RuntimeError(token, "Operands of arithmetic comparison (>, >=, <, <=) must be of type Number.");
     }
+
+    auto result = op(left.asNumber(), right.asNumber());
+    temporary = Value::boolean(result);
 }
 
 void Interpreter::visit(Literal &expression) {
+    if (expression.specialization == Literal::Specialization::CONSTANT) {
+        temporary = expression.value;
+        return;
+    }
+
     const string &lexeme = expression.token->lexeme;
 
     switch (expression.token->type) {
 
         case TokenType::NIL: {
-            temporary = Nil::New();
+            temporary = Value::nil();
             break;
         }
 
         case TokenType::NUMBER: {
             double value = stod(lexeme);
 
-            temporary = Number::New(value);
+            temporary = Value::number(value);
             break;
         }
 
         case TokenType::STRING: {
+            // pinned, since the literal keeps it
             string value = lexeme.substr(1, lexeme.length() - 2);
 
-            temporary = String::New(value);
+            temporary = String::NewSymbol(value);
             break;
         }
 
         case TokenType::TRUE: {
-            temporary = Boolean::New(true);
+            temporary = Value::boolean(true);
             break;
         }
 
         case TokenType::FALSE: {
-            temporary = Boolean::New(false);
+            temporary = Value::boolean(false);
             break;
         }
 
         default: ;
     }
+
+    expression.specialization = Literal::Specialization::CONSTANT;
+    expression.value = temporary;
 }
 
 void Interpreter::visit(Logical &expression) {
     evaluate(*expression.left);
 
-    if (temporary->isTruthy()) {
+    if (temporary.isTruthy()) {
         if (expression.token->type == TokenType::AND) {
             // a and b = b if a, else a
             evaluate(*expression.right);
@@ -368,32 +669,45 @@ void Interpreter::visit(Grouping &expression) {
 }
 
 void Interpreter::visit(Variable &expression) {
-    // We have to copy here, other wise expressions like (-a) would change the state of a
-//    auto value = environment->get(*expression.name);
-    auto value = lookUpVariable(*expression.name, expression);
-    temporary = move(value->clone());
+    // Values are immutable, so the stored value can be shared rather than copied
+    switch (expression.access) {
+        case Access::GLOBAL:
+            temporary = globals->get(bind(expression.global, *expression.name), *expression.name);
+            break;
+
+        case Access::LOCAL:
+            temporary = local(expression.slot);
+            break;
+
+        case Access::CELL:
+            temporary = local(expression.slot).as<Cell>()->get();
+            break;
+
+        case Access::UPVALUE:
+            temporary = function->upvalues()[expression.slot]->get();
+            break;
+    }
 }
 
 void Interpreter::visit(Assign &expression) {
     evaluate(*expression.value);
 
-    auto distance = locals.find(&expression);
+    switch (expression.access) {
+        case Access::GLOBAL:
+            globals->assign(bind(expression.global, *expression.name), *expression.name, temporary);
+            break;
 
-    if (distance != locals.end()) {
-        environment->assignAt(distance->second, *expression.name, temporary);
-    } else {
-        globals->assign(*expression.name, temporary);
-    }
-//    environment->assign(*expression.name, temporary);
-}
+        case Access::LOCAL:
+            local(expression.slot) = temporary;
+            break;
 
-Object_ptr Interpreter::lookUpVariable(const Token &name, Expression &expression) {
-    auto distance = locals.find(&expression);
+        case Access::CELL:
+            local(expression.slot).as<Cell>()->set(temporary);
+            break;
 
-    if (distance != locals.end()) {
-        return environment->getAt(distance->second, name.lexeme);
-    } else {
-        return globals->get(name);
+        case Access::UPVALUE:
+            function->upvalues()[expression.slot]->set(temporary);
+            break;
     }
 }
 
@@ -5,34 +5,61 @@
 #ifndef LOX_INTERPRETER_INTERPRETER_H
 #define LOX_INTERPRETER_INTERPRETER_H
 
+#include <array>
+#include <cstddef>
+#include <string>
 #include <vector>
 #include <memory>
+#include <functional>
 #include <error.h>
 
 #include "data/expression.h"
 #include "data/statement.h"
 #include "LoxObject.h"
-#include "Environment.h"
+#include "Cell.h"
+#include "Globals.h"
+#include "Heap.h"
 
-using Comparison = std::function<bool(double, double)>;
-using Arithmetic = std::function<double(double, double)>;
+class Callable;
+class FunctionObject;
+
+// Handlers for "+", indexed by the kinds of the left and right operand. Empty entries are type errors.
+using PlusHandler = Value (*)(const Value &left, const Value &right);
+extern const std::array<std::array<PlusHandler, KINDS>, KINDS> plusHandlers;
+
+// the message of the error "+" raises for operands it has no handler for
+std::string plusError(const Value &left);
 
 /*
  * Executes Lox statements given as an Abstract Syntax Tree (AST)
  */
-class Interpreter : public ExpressionVisitor, StatementVisitor {
+class Interpreter : public ExpressionVisitor, StatementVisitor, RootSet {
 
 public:
-    Environment_ptr globals;
+    // owns all objects created by this interpreter, hence declared (and destroyed) first
+    Heap heap;
+
+    Globals *globals;
 
     Interpreter();
 
-    // Interpret Lox code
-    void interpret(const std::vector<Statement_ptr> &statements);
+    // Interpret Lox code, given the size of the top-level frame as determined by the Resolver
+    void interpret(const std::vector<Statement_ptr> &statements, std::size_t slots);
     void evaluate(Expression &expression);
     void execute(Statement &statement);
-    void executeBlock(const std::vector<Statement_ptr> &statements, Environment_ptr environment);
-    void resolve(Expression &expression, int depth);
+
+    // executes statements in order until one of them completes abruptly
+    void execute(const std::vector<Statement_ptr> &statements);
+
+    // calls a function whose arguments are on the stack, starting at the given index
+    Value call(const FunctionObject &function, std::size_t arguments);
+
+    const Value* argumentsAt(std::size_t arguments) const {
+        return stack.data() + arguments;
+    }
+
+    // RootSet interface for the garbage collector
+    void markRoots(Heap &heap) override;
 
     // Member functions for Statement visitor interface
     void visit(ExpressionStatement &statement) override;
@@ -56,26 +83,54 @@ public:
 
 private:
     // intermediate result of expression evaluation
-    Object_ptr temporary = nullptr;
+    Value temporary;
 
-    // currently active environment
-    Environment_ptr environment;
+    // How the last statement completed. Statements that complete abruptly skip the rest of every enclosing statement up
+    // to the one that handles them, e.g. a return the rest of the function body, with its value in `temporary`.
+    enum class Completion {
+        NORMAL, RETURN,
 
-    // side table for resolutions
-    std::unordered_map<Expression*, int> locals;
+        // a return of a call to a Lox function, which has replaced the current frame with the callee and its arguments
+        TAIL_CALL
+    };
 
-    Object_ptr lookUpVariable(const Token &name, Expression &expression);
+    Completion completion = Completion::NORMAL;
 
-    // Helper functions
-    void comparison(const LoxObject &left, const LoxObject &right, const Comparison &op, const Token &token);
-    void arithmetic(const LoxObject &left, const LoxObject &right, const Arithmetic &op, const Token &token);
-};
+    // Local variables and Values that are only referenced from the native call stack (e.g. the left operand of a binary
+    // expression while the right one is evaluated), kept reachable for the collector. Each call pushes the callee and
+    // its arguments, which become the first slots of the callee's frame; the frame's other slots follow them.
+    std::vector<Value> stack;
 
+    // index of the current frame's first slot, and the function it belongs to (nullptr at the top level)
+    std::size_t frame = 0;
+    const FunctionObject *function = nullptr;
 
-struct ReturnValue {
-    Object_ptr value;
+    Value& local(int slot) {
+        return stack[frame + slot];
+    }
 
-    explicit ReturnValue(Object_ptr value = nullptr) : value{move(value)} {}
+    // evaluates the callee and arguments of a call onto the stack and checks that they match
+    const Callable& push(Call &expression);
+
+    // defines a variable where the Resolver placed it
+    void define(Access access, int slot, const Token &name, Value value);
+
+    // the index of a global variable, looked up by name on first use and cached in the syntax tree
+    int bind(int &global, const Token &name);
+
+    // applies a Binary node's operator as it specialized itself, unless the operands fail its guard
+    bool specialized(Binary &expression, const Value &left, const Value &right);
+
+    // applies a Binary node's operator to any operands, specializing the node on its first execution
+    void generic(Binary &expression, const Value &left, const Value &right);
+
+    // Helper functions
+    template<typename Operation>
+    void comparison(const Value &left, const Value &right, Operation op, const Token &token);
+
+    template<typename Operation>
+    void arithmetic(const Value &left, const Value &right, Operation op, const Token &token);
 };
 
+
 #endif //LOX_INTERPRETER_INTERPRETER_H
@@ -5,84 +5,106 @@
 #include "LoxObject.h"
 
 #include <iostream>
+#include <string_view>
 
 using namespace std;
 
-// Factory Functions
+// String interning
 
-shared_ptr<Number> Number::New(double value) {
-    return make_shared<Number>(value);   
-}
+String::String(string value)
+    : LoxObject{Kind::STRING},
+      buffer{make_shared<string>(move(value))},
+      length{buffer->size()},
+      interned{true},
+      hash{std::hash<string_view>{}(*buffer)} {}
 
-shared_ptr<Boolean> Boolean::New(bool value) {
-    return make_shared<Boolean>(value);
-}
+String::String(shared_ptr<string> buffer, size_t length)
+    : LoxObject{Kind::STRING}, buffer{move(buffer)}, length{length}, interned{false}, hash{0} {}
 
-shared_ptr<String> String::New(string value) {
-    return make_shared<String>(move(value));
+String::~String() {
+    if (interned) {
+        Heap::current().removeString(this);
+    }
 }
 
-shared_ptr<Nil> Nil::New() {
-    return make_shared<Nil>();
-}
+Value String::New(string value) {
+    auto &heap = Heap::current();
 
+    if (auto interned = heap.findString(value)) {
+        return Value::object(interned);
+    }
 
-// Deep copy
+    auto string = heap.allocate<String>(move(value));
+    heap.addString(string);
 
-Object_ptr Number::clone() const {
-    return make_shared<Number>(*this);
+    return Value::object(string);
 }
 
-Object_ptr Boolean::clone() const {
-    return make_shared<Boolean>(*this);
-}
+Value String::NewSymbol(string value) {
+    auto symbol = New(move(value));
+    Heap::current().pin(symbol.asObject());
 
-Object_ptr String::clone() const {
-    return make_shared<String>(*this);
+    return symbol;
 }
 
-Object_ptr Nil::clone() const {
-    return make_shared<Nil>(*this);
-}
 
+// Concatenation
 
-// Truthiness
+Value String::concatenate(const String &left, const String &right) {
+    auto length = left.length + right.length;
 
-bool LoxObject::isTruthy() const {
-    return true;
-}
+    // If nothing has been appended to left yet, its buffer can be extended in place. Interned buffers are never
+    // extended, since the table refers to their contents.
+    if (not left.interned and left.length == left.buffer->size()) {
+        if (left.buffer == right.buffer) {
+            // right is a prefix of the very buffer we are about to grow
+            left.buffer->append(string{right.value()});
+        } else {
+            left.buffer->append(right.value());
+        }
+
+        return Value::object(Heap::current().allocate<String>(left.buffer, length));
+    }
+
+    // Otherwise start a new buffer, which subsequent appends can extend
+    auto buffer = make_shared<string>();
+    buffer->reserve(2 * length);
+    buffer->append(left.value());
+    buffer->append(right.value());
 
-bool Boolean::isTruthy() const {
-    return value;
+    return Value::object(Heap::current().allocate<String>(move(buffer), length));
 }
 
-bool Nil::isTruthy() const {
-    return false;
+
+// Tracing
+
+void String::trace(Heap &heap) const {
+    // Strings don't refer to other objects
 }
 
+
 // Printing to ostream
 
 ostream& operator<<(ostream &out, const LoxObject &object) {
     return object.print(out);
 }
 
-ostream& Number::print(ostream &out) const {
-    out << value;
-    return out;
-}
+ostream& operator<<(ostream &out, const Value &value) {
+    if (value.isNumber()) {
+        out << value.asNumber();
+    } else if (value.isBoolean()) {
+        out << boolalpha << value.asBoolean();
+    } else if (value.isNil()) {
+        out << "nil";
+    } else {
+        out << *value.asObject();
+    }
 
-ostream& Boolean::print (ostream &out) const {
-    out << boolalpha << value;
     return out;
 }
 
 ostream& String::print (ostream &out) const {
-    out << value;
-    return out;
-}
-
-ostream& Nil::print (ostream &out) const {
-    out << "nil";
+    out << value();
     return out;
 }
 
@@ -96,34 +118,21 @@ bool operator!=(const LoxObject &left, const LoxObject &right) {
     return !left.equals(right);
 }
 
-bool Number::equals(const LoxObject &object) const {
-    if (auto other = dynamic_cast<const Number*>(&object)) {
-        return this->value == other->value;
-    }
-
-    return false;
-}
-
-bool Boolean::equals(const LoxObject &object) const {
-    if (auto other = dynamic_cast<const Boolean*>(&object)) {
-        return this->value == other->value;
-    }
-
-    return false;
+bool Value::equalObjects(const Value &left, const Value &right) {
+    return *left.asObject() == *right.asObject();
 }
 
 bool String::equals(const LoxObject &object) const {
-    if (auto other = dynamic_cast<const String*>(&object)) {
-        return this->value == other->value;
+    if (not String::classof(object)) {
+        return false;
     }
 
-    return false;
-}
+    auto &other = static_cast<const String&>(object);
 
-bool Nil::equals(const LoxObject &object) const {
-    if (auto other = dynamic_cast<const Nil*>(&object)) {
-        return true;
+    // interned Strings with equal contents are identical objects
+    if (this->interned and other.interned) {
+        return this == &other;
     }
 
-    return false;
-}
\ No newline at end of file
+    return this->value() == other.value();
+}
@@ -2,27 +2,48 @@
 // Created by Lucas Wolf on 2019-02-22.
 //
 
-#ifndef LOX_INTERPRETER_VALUE_H
-#define LOX_INTERPRETER_VALUE_H
+#ifndef LOX_INTERPRETER_LOXOBJECT_H
+#define LOX_INTERPRETER_LOXOBJECT_H
+
+#include "Value.h"
+#include "Heap.h"
 
 #include <string>
+#include <string_view>
+#include <memory>
 #include <iostream>
+#include <cstddef>
+#include <cstdint>
+
+
+/*
+ * The kind of a Value. Type checks compare kinds instead of relying on RTTI, and binary operators dispatch on the kinds
+ * of their operands through tables indexed by (left kind, right kind).
+ */
+enum class Kind : std::uint8_t {
+    NIL, BOOLEAN, NUMBER, STRING, NATIVE, FUNCTION, CELL
+};
 
-struct LoxObject;
-using Object_ptr = std::shared_ptr<LoxObject>;
+constexpr std::size_t KINDS = 7;
 
 
-struct LoxObject {
+/*
+ * Base class for all values that live on the heap. Numbers, booleans and nil are stored inline in a Value instead.
+ *
+ * Objects are immutable once constructed, so Values referring to them can be copied and shared freely: operators
+ * always produce new results rather than modifying their operands.
+ */
+struct LoxObject : public HeapObject {
 
 private:
     virtual std::ostream& print(std::ostream &out) const = 0;
     virtual bool equals(const LoxObject &object) const = 0;
 
-public:
-    virtual ~LoxObject() = default;
-    virtual Object_ptr clone() const = 0;
+protected:
+    explicit LoxObject(Kind kind) : kind{kind} {}
 
-    virtual bool isTruthy() const;
+public:
+    const Kind kind;
 
     friend std::ostream& operator<< (std::ostream &out, const LoxObject &object);
     friend bool operator== (const LoxObject &left, const LoxObject &right);
@@ -30,67 +51,92 @@ public:
 };
 
 
-struct Number : public LoxObject {
+/*
+ * Strings are immutable sequences of characters. They come in two flavours:
+ *
+ * - Interned Strings are created by String::New. All interned Strings with the same contents share a single object,
+ *   so their equality is pointer identity and their hash is computed once on creation.
+ * - Concatenations are created by String::concatenate. Their contents are a prefix of a shared, append-only buffer:
+ *   appending to the String that ends at the end of the buffer extends the buffer in place, which makes building a
+ *   string piece by piece amortized O(1) per append rather than copying the whole string every time.
+ */
+struct String : public LoxObject {
 
 private:
     std::ostream& print(std::ostream &out) const override;
     bool equals(const LoxObject &object) const override;
 
-public:
-    double value;
+    // the contents of this String are the first `length` characters of `buffer`
+    std::shared_ptr<std::string> buffer;
 
-    explicit Number(double value) : value{value} {};
-    static std::shared_ptr<Number> New(double value);
+    explicit String(std::string value);
+    explicit String(std::shared_ptr<std::string> buffer, std::size_t length);
 
-    Object_ptr clone() const override;
-};
+    friend class Heap;
 
+public:
+    static bool classof(const LoxObject &object) {
+        return object.kind == Kind::STRING;
+    }
 
-struct Boolean : public LoxObject {
+    const std::size_t length;
+    const bool interned;
 
-private:
-    std::ostream& print(std::ostream &out) const override;
-    bool equals(const LoxObject &object) const override;
+    // only meaningful for interned Strings
+    const std::size_t hash;
 
-public:
-    bool value;
+    // interned Strings remove themselves from the table once they are collected
+    ~String() override;
 
-    explicit Boolean(bool value) : value{value} {};
-    static std::shared_ptr<Boolean> New(bool value);
+    void trace(Heap &heap) const override;
 
-    bool isTruthy() const override;
-    Object_ptr clone() const override;
-};
+    std::string_view value() const {
+        return {buffer->data(), length};
+    }
 
+    // returns the interned String with the given contents, creating it if necessary
+    static Value New(std::string value);
 
-struct String : public LoxObject {
+    // like New, but keeps the String alive for good, for names referenced by the syntax tree
+    static Value NewSymbol(std::string value);
 
-private:
-    std::ostream& print(std::ostream &out) const override;
-    bool equals(const LoxObject &object) const override;
+    // returns a String with the contents of left followed by those of right
+    static Value concatenate(const String &left, const String &right);
+};
 
-public:
-    std::string value;
 
-    explicit String(std::string value) : value{ std::move(value) } {};
-    static std::shared_ptr<String> New(std::string value);
+// Type checks
 
-    Object_ptr clone() const override;
-};
+template<typename T>
+bool Value::is() const noexcept {
+    return isObject() and T::classof(*asObject());
+}
 
+inline Kind kindOf(const Value &value) {
+    if (value.isNumber()) {
+        return Kind::NUMBER;
+    }
 
-struct Nil : public LoxObject {
+    if (value.isObject()) {
+        return value.asObject()->kind;
+    }
 
-private:
-    std::ostream& print(std::ostream &out) const override;
-    bool equals(const LoxObject &object) const override;
+    return value.isNil() ? Kind::NIL : Kind::BOOLEAN;
+}
 
-public:
-    static std::shared_ptr<Nil> New();
 
-    bool isTruthy() const override;
-    Object_ptr clone() const override;
+// Hashing and equality for interned Strings used as keys, e.g. variable names
+struct SymbolHash {
+    std::size_t operator()(const Value &symbol) const noexcept {
+        return symbol.as<String>()->hash;
+    }
+};
+
+struct SymbolEqual {
+    bool operator()(const Value &left, const Value &right) const noexcept {
+        return left.asObject() == right.asObject();
+    }
 };
 
 
-#endif //LOX_INTERPRETER_VALUE_H
+#endif //LOX_INTERPRETER_LOXOBJECT_H
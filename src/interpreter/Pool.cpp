@@ -0,0 +1,44 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "Pool.h"
+
+#include <cassert>
+
+using namespace std;
+
+Pool::Pool(size_t slotSize) : size{slotSize} {
+    assert(size >= sizeof(FreeSlot) and size <= SLAB_SIZE);
+}
+
+void* Pool::allocate() {
+    ++count;
+
+    if (freeList) {
+        auto slot = freeList;
+        freeList = slot->next;
+
+        return slot;
+    }
+
+    if (unused == nullptr or static_cast<size_t>(end - unused) < size) {
+        slabs.emplace_back(new byte[SLAB_SIZE]);
+
+        unused = slabs.back().get();
+        end = unused + SLAB_SIZE;
+    }
+
+    auto slot = unused;
+    unused += size;
+
+    return slot;
+}
+
+void Pool::free(void *slot) {
+    --count;
+
+    auto freed = static_cast<FreeSlot*>(slot);
+    freed->next = freeList;
+    freeList = freed;
+}
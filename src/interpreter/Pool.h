@@ -0,0 +1,63 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_POOL_H
+#define LOX_INTERPRETER_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+/*
+ * Allocates fixed-size slots out of large slabs. Freed slots are kept on a free list and handed out again before a
+ * slab is carved any further. Slabs are only returned to the system when the Pool itself is destroyed, all at once.
+ */
+class Pool {
+
+public:
+    // the size of a slab, from which all slots of a Pool are carved
+    static constexpr std::size_t SLAB_SIZE = 64 * 1024;
+
+    explicit Pool(std::size_t slotSize);
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    Pool(Pool&&) = default;
+
+    void* allocate();
+    void free(void *slot);
+
+    std::size_t slotSize() const {
+        return size;
+    }
+
+    // the number of slots currently allocated
+    std::size_t live() const {
+        return count;
+    }
+
+    // the number of bytes obtained from the system, used or not
+    std::size_t bytes() const {
+        return slabs.size() * SLAB_SIZE;
+    }
+
+private:
+    struct FreeSlot {
+        FreeSlot *next;
+    };
+
+    std::size_t size;
+    std::size_t count = 0;
+
+    FreeSlot *freeList = nullptr;
+
+    // the part of the newest slab that has not been handed out yet
+    std::byte *unused = nullptr;
+    std::byte *end = nullptr;
+
+    std::vector<std::unique_ptr<std::byte[]>> slabs;
+};
+
+#endif //LOX_INTERPRETER_POOL_H
@@ -15,7 +15,8 @@
  */
 struct RuntimeError : LoxError {
 
-    const Token &token;
+    // copied, since the error outlives the syntax tree it was raised in
+    const Token token;
     const std::string message;
 
     RuntimeError(const Token &token, std::string message);
@@ -0,0 +1,137 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_VALUE_H
+#define LOX_INTERPRETER_VALUE_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+// Forward declarations
+struct LoxObject;
+
+
+/*
+ * A Lox value, packed into 64 bits ("NaN boxing").
+ *
+ * Numbers are stored as plain IEEE 754 doubles. Every other value hides in the payload bits of a quiet NaN, which
+ * arithmetic never produces: nil, true and false are tagged immediates, heap objects (strings, callables) are pointers
+ * with the sign bit set. Heap objects are owned by the garbage collector (see Heap.h), so Values are trivially copyable
+ * and numbers and booleans never touch the allocator.
+ */
+class Value {
+
+public:
+    // nil
+    constexpr Value() noexcept : bits{QNAN | TAG_NIL} {}
+
+    // Factory functions
+    static Value number(double value) noexcept {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(double));
+        return Value{bits};
+    }
+
+    // nil, true and false are single, canonical bit patterns, so they never allocate and compare by identity
+    static constexpr Value boolean(bool value) noexcept {
+        return Value{QNAN | (value ? TAG_TRUE : TAG_FALSE)};
+    }
+
+    static constexpr Value nil() noexcept {
+        return Value{};
+    }
+
+    static Value object(const LoxObject *object) noexcept {
+        return Value{SIGN_BIT | QNAN | reinterpret_cast<uint64_t>(object)};
+    }
+
+    // Type checks
+    bool isNumber() const noexcept { return (bits & QNAN) != QNAN; }
+    bool isBoolean() const noexcept { return (bits | 1u) == (QNAN | TAG_TRUE); }
+    bool isNil() const noexcept { return bits == (QNAN | TAG_NIL); }
+    bool isObject() const noexcept { return (bits & (QNAN | SIGN_BIT)) == (QNAN | SIGN_BIT); }
+
+    // Unchecked accessors, only valid after the corresponding type check
+    double asNumber() const noexcept {
+        double value;
+        std::memcpy(&value, &bits, sizeof(double));
+        return value;
+    }
+
+    bool asBoolean() const noexcept { return bits == (QNAN | TAG_TRUE); }
+
+    LoxObject* asObject() const noexcept {
+        return reinterpret_cast<LoxObject*>(bits & ~(SIGN_BIT | QNAN));
+    }
+
+    // the object as a specific subclass, which the caller must already know it to be
+    template<typename T>
+    T* as() const noexcept {
+        return static_cast<T*>(asObject());
+    }
+
+    // whether this is an object of the given subclass (defined in LoxObject.h)
+    template<typename T>
+    bool is() const noexcept;
+
+    // nil and false are falsey, everything else is truthy. Their tags are adjacent, so this takes a single comparison.
+    bool isTruthy() const noexcept {
+        static_assert(TAG_FALSE == TAG_NIL + 1, "nil and false must be adjacent");
+        return bits - (QNAN | TAG_NIL) > 1;
+    }
+
+    // the representation, for code outside the interpreter that shares it (see transpiler/Runtime.h)
+    static constexpr Value fromBits(uint64_t bits) noexcept {
+        return Value{bits};
+    }
+
+    constexpr uint64_t toBits() const noexcept {
+        return bits;
+    }
+
+    friend std::ostream& operator<< (std::ostream &out, const Value &value);
+
+    friend bool operator== (const Value &left, const Value &right) {
+        // Identical Values are equal, except for NaN. This covers nil, booleans and interned Strings.
+        if (left.bits == right.bits) {
+            return not left.isNumber() or left.asNumber() == left.asNumber();
+        }
+
+        if (left.isNumber() and right.isNumber()) {
+            // e.g. 0 and -0
+            return left.asNumber() == right.asNumber();
+        }
+
+        return left.isObject() and right.isObject() and equalObjects(left, right);
+    }
+
+    friend bool operator!= (const Value &left, const Value &right) {
+        return not (left == right);
+    }
+
+private:
+    // builds and checks Values in machine code
+    friend class NativeCompiler;
+
+    static constexpr uint64_t SIGN_BIT = 0x8000000000000000;
+    static constexpr uint64_t QNAN = 0x7ffc000000000000;
+
+    static constexpr uint64_t TAG_NIL = 1;
+    static constexpr uint64_t TAG_FALSE = 2;
+    static constexpr uint64_t TAG_TRUE = 3;
+
+    uint64_t bits;
+
+    constexpr explicit Value(uint64_t bits) noexcept : bits{bits} {}
+
+    // compares distinct objects by contents (defined in LoxObject.cpp)
+    static bool equalObjects(const Value &left, const Value &right);
+};
+
+static_assert(sizeof(Value) == sizeof(double), "Values must fit into 64 bits");
+static_assert(std::is_trivially_copyable<Value>::value, "Values must be trivially copyable");
+
+#endif //LOX_INTERPRETER_VALUE_H
@@ -0,0 +1,244 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "Assembler.h"
+
+#include <cassert>
+
+using namespace std;
+
+static uint8_t number(Reg reg) {
+    return static_cast<uint8_t>(reg);
+}
+
+static uint8_t number(Xmm reg) {
+    return static_cast<uint8_t>(reg);
+}
+
+// Labels
+
+Assembler::Label Assembler::label() {
+    labels.push_back(SIZE_MAX);
+    return labels.size() - 1;
+}
+
+void Assembler::bind(Label label) {
+    labels[label] = code.size();
+}
+
+vector<uint8_t> Assembler::finish() {
+    for (auto [position, target] : jumps) {
+        assert(labels[target] != SIZE_MAX && "jump to an unbound label");
+
+        // relative to the end of the displacement, which ends the instruction
+        auto relative = static_cast<int32_t>(labels[target] - (position + 4));
+
+        for (int i = 0; i < 4; ++i) {
+            code[position + i] = static_cast<uint32_t>(relative) >> (8 * i) & 0xff;
+        }
+    }
+
+    jumps.clear();
+    return std::move(code);
+}
+
+// Encoding
+
+void Assembler::byte(uint8_t value) {
+    code.push_back(value);
+}
+
+void Assembler::bytes(uint64_t value, int count) {
+    // little endian
+    for (int i = 0; i < count; ++i) {
+        byte(value >> (8 * i) & 0xff);
+    }
+}
+
+void Assembler::rex(uint8_t reg, uint8_t rm) {
+    // W: 64 bit operands, R and B: the high bits of the register numbers
+    byte(0x48 | (reg >> 3 & 1) << 2 | (rm >> 3 & 1));
+}
+
+void Assembler::direct(uint8_t reg, uint8_t rm) {
+    byte(0xc0 | (reg & 7) << 3 | (rm & 7));
+}
+
+void Assembler::arithmetic(uint8_t opcode, Reg dst, Reg src) {
+    rex(number(src), number(dst));
+    byte(opcode);
+    direct(number(src), number(dst));
+}
+
+void Assembler::sse(uint8_t prefix, uint8_t opcode, Xmm dst, Xmm src) {
+    byte(prefix);
+    byte(0x0f);
+    byte(opcode);
+    direct(number(dst), number(src));
+}
+
+void Assembler::displacement(Label target) {
+    jumps.emplace_back(code.size(), target);
+    bytes(0, 4);
+}
+
+// Instructions
+
+void Assembler::load(Reg dst, Reg base, int32_t displacement) {
+    rex(number(dst), number(base));
+    byte(0x8b);
+
+    // [base + disp32]; RSP and R12 as the base need a SIB byte
+    byte(0x80 | (number(dst) & 7) << 3 | (number(base) & 7));
+    if ((number(base) & 7) == 4) {
+        byte(0x24);
+    }
+
+    bytes(static_cast<uint32_t>(displacement), 4);
+}
+
+void Assembler::store(Reg base, int32_t displacement, Reg src) {
+    rex(number(src), number(base));
+    byte(0x89);
+
+    byte(0x80 | (number(src) & 7) << 3 | (number(base) & 7));
+    if ((number(base) & 7) == 4) {
+        byte(0x24);
+    }
+
+    bytes(static_cast<uint32_t>(displacement), 4);
+}
+
+void Assembler::move(Reg dst, uint64_t immediate) {
+    rex(0, number(dst));
+    byte(0xb8 + (number(dst) & 7));
+    bytes(immediate, 8);
+}
+
+void Assembler::move32(Reg dst, uint32_t immediate) {
+    if (number(dst) >= 8) {
+        byte(0x41);
+    }
+
+    byte(0xb8 + (number(dst) & 7));
+    bytes(immediate, 4);
+}
+
+void Assembler::move(Reg dst, Reg src) {
+    arithmetic(0x89, dst, src);
+}
+
+void Assembler::add(Reg dst, Reg src) {
+    arithmetic(0x01, dst, src);
+}
+
+void Assembler::subtract(Reg dst, Reg src) {
+    arithmetic(0x29, dst, src);
+}
+
+void Assembler::bitAnd(Reg dst, Reg src) {
+    arithmetic(0x21, dst, src);
+}
+
+void Assembler::bitOr(Reg dst, Reg src) {
+    arithmetic(0x09, dst, src);
+}
+
+void Assembler::bitXor(Reg dst, Reg src) {
+    arithmetic(0x31, dst, src);
+}
+
+void Assembler::compare(Reg dst, Reg src) {
+    arithmetic(0x39, dst, src);
+}
+
+void Assembler::compare(Reg dst, int8_t immediate) {
+    rex(0, number(dst));
+    byte(0x83);
+    direct(7, number(dst));
+    byte(static_cast<uint8_t>(immediate));
+}
+
+void Assembler::set(Condition condition, Reg dst) {
+    // without a REX prefix, the byte registers 4 to 7 would be AH, CH, DH and BH
+    auto high = number(dst) >> 3 & 1;
+
+    if (number(dst) >= 4) {
+        byte(0x40 | high);
+    }
+
+    // setcc dst8
+    byte(0x0f);
+    byte(0x90 | static_cast<uint8_t>(condition));
+    direct(0, number(dst));
+
+    // movzx dst32, dst8, which clears the upper half as well
+    if (number(dst) >= 4) {
+        byte(0x40 | high << 2 | high);
+    }
+
+    byte(0x0f);
+    byte(0xb6);
+    direct(number(dst), number(dst));
+}
+
+void Assembler::move(Xmm dst, Reg src) {
+    byte(0x66);
+    rex(number(dst), number(src));
+    byte(0x0f);
+    byte(0x6e);
+    direct(number(dst), number(src));
+}
+
+void Assembler::move(Reg dst, Xmm src) {
+    byte(0x66);
+    rex(number(src), number(dst));
+    byte(0x0f);
+    byte(0x7e);
+    direct(number(src), number(dst));
+}
+
+void Assembler::addDouble(Xmm dst, Xmm src) {
+    sse(0xf2, 0x58, dst, src);
+}
+
+void Assembler::subtractDouble(Xmm dst, Xmm src) {
+    sse(0xf2, 0x5c, dst, src);
+}
+
+void Assembler::multiplyDouble(Xmm dst, Xmm src) {
+    sse(0xf2, 0x59, dst, src);
+}
+
+void Assembler::divideDouble(Xmm dst, Xmm src) {
+    sse(0xf2, 0x5e, dst, src);
+}
+
+void Assembler::compareDouble(Xmm left, Xmm right) {
+    sse(0x66, 0x2e, left, right);
+}
+
+void Assembler::jump(Label target) {
+    byte(0xe9);
+    displacement(target);
+}
+
+void Assembler::jump(Condition condition, Label target) {
+    byte(0x0f);
+    byte(0x80 | static_cast<uint8_t>(condition));
+    displacement(target);
+}
+
+void Assembler::jump(Reg target) {
+    if (number(target) >= 8) {
+        byte(0x41);
+    }
+
+    byte(0xff);
+    direct(4, number(target));
+}
+
+void Assembler::ret() {
+    byte(0xc3);
+}
@@ -0,0 +1,115 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_ASSEMBLER_H
+#define LOX_INTERPRETER_ASSEMBLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// general purpose registers, numbered as in the instruction encoding
+enum class Reg : std::uint8_t {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15
+};
+
+// SSE registers
+enum class Xmm : std::uint8_t {
+    XMM0, XMM1
+};
+
+// condition codes, numbered as in the encoding of Jcc and SETcc; the unsigned ones (BELOW, ABOVE, ...) also apply to
+// the flags UCOMISD sets
+enum class Condition : std::uint8_t {
+    BELOW = 0x2, ABOVE_EQUAL = 0x3, EQUAL = 0x4, NOT_EQUAL = 0x5, BELOW_EQUAL = 0x6, ABOVE = 0x7, PARITY = 0xa,
+    NO_PARITY = 0xb
+};
+
+/*
+ * Emits the few x86-64 instructions the baseline JIT needs into a buffer of bytes. Jumps go to labels, which may be
+ * bound before or after the jump; their 32 bit displacements are filled in by `finish`.
+ */
+class Assembler {
+
+public:
+    using Label = std::size_t;
+
+    Label label();
+    void bind(Label label);
+
+    // the offset of the next instruction
+    std::size_t offset() const {
+        return code.size();
+    }
+
+    // mov dst, [base + displacement] / mov [base + displacement], src
+    void load(Reg dst, Reg base, std::int32_t displacement);
+    void store(Reg base, std::int32_t displacement, Reg src);
+
+    // mov dst, immediate / mov eax-like dst, 32 bit immediate (zero extended)
+    void move(Reg dst, std::uint64_t immediate);
+    void move32(Reg dst, std::uint32_t immediate);
+
+    // <op> dst, src on 64 bit registers
+    void move(Reg dst, Reg src);
+    void add(Reg dst, Reg src);
+    void subtract(Reg dst, Reg src);
+    void bitAnd(Reg dst, Reg src);
+    void bitOr(Reg dst, Reg src);
+    void bitXor(Reg dst, Reg src);
+    void compare(Reg dst, Reg src);
+    void compare(Reg dst, std::int8_t immediate);
+
+    // the low byte of dst = the condition, 0 or 1, zero extended to 64 bit
+    void set(Condition condition, Reg dst);
+
+    // movq between general purpose and SSE registers
+    void move(Xmm dst, Reg src);
+    void move(Reg dst, Xmm src);
+
+    // addsd, subsd, mulsd, divsd, ucomisd
+    void addDouble(Xmm dst, Xmm src);
+    void subtractDouble(Xmm dst, Xmm src);
+    void multiplyDouble(Xmm dst, Xmm src);
+    void divideDouble(Xmm dst, Xmm src);
+    void compareDouble(Xmm left, Xmm right);
+
+    void jump(Label target);
+    void jump(Condition condition, Label target);
+    void jump(Reg target);
+    void ret();
+
+    // the machine code, with all jumps resolved
+    std::vector<std::uint8_t> finish();
+
+private:
+    std::vector<std::uint8_t> code;
+
+    // the offset of every label, once bound
+    std::vector<std::size_t> labels;
+
+    // the offsets of the displacements of jumps, and their targets
+    std::vector<std::pair<std::size_t, Label>> jumps;
+
+    void byte(std::uint8_t value);
+    void bytes(std::uint64_t value, int count);
+
+    // the REX prefix for a 64 bit operation with the given ModRM reg and r/m operands
+    void rex(std::uint8_t reg, std::uint8_t rm);
+
+    // a ModRM byte addressing a register directly
+    void direct(std::uint8_t reg, std::uint8_t rm);
+
+    // <opcode> r/m, reg on two 64 bit registers
+    void arithmetic(std::uint8_t opcode, Reg dst, Reg src);
+
+    // an SSE2 instruction on two SSE registers
+    void sse(std::uint8_t prefix, std::uint8_t opcode, Xmm dst, Xmm src);
+
+    void displacement(Label target);
+};
+
+
+#endif //LOX_INTERPRETER_ASSEMBLER_H
@@ -0,0 +1,395 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "BaselineJit.h"
+
+#if defined(__x86_64__) and (defined(__linux__) or defined(__APPLE__))
+#define LOX_HAS_JIT
+#endif
+
+#ifdef LOX_HAS_JIT
+#include "Assembler.h"
+
+#include <cstring>
+#include <fstream>
+#include <ios>
+
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+NativeCode::NativeCode(uint8_t *memory, size_t size, vector<uint32_t> &&entries)
+    : memory{memory}, size{size}, entries{move(entries)} {}
+
+#ifndef LOX_HAS_JIT
+
+NativeCode::~NativeCode() = default;
+
+shared_ptr<NativeCode> compileNative(const Chunk &chunk, const string &name) {
+    return nullptr;
+}
+
+#else
+
+NativeCode::~NativeCode() {
+    // Frees the pages but keeps the addresses reserved for good, replacing the code with an inaccessible mapping. Code
+    // compiled later never reuses them, so the symbols in the perf map never overlap.
+    mmap(memory, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+}
+
+/*
+ * Emits the template of every instruction. The registers of the frame stay in memory, addressed relative to RDI, and
+ * every template loads its operands and stores its result, so the frame is always up to date. RAX, RCX, RDX, XMM0 and
+ * XMM1 are scratch registers; R8, R9 and R10 hold constants of the Value representation. Nothing is called and no
+ * callee-saved register is used, so the code needs no stack frame.
+ */
+class NativeCompiler {
+
+public:
+    explicit NativeCompiler(const Chunk &chunk) : chunk{chunk} {}
+
+    // the machine code and the offset of every instruction in it, or false if the chunk can't be compiled
+    bool compile(vector<uint8_t> &code, vector<uint32_t> &entries);
+
+private:
+    using Op = RegisterOp;
+
+    static constexpr Reg SLOTS = Reg::RDI;
+    static constexpr Reg NAN_BITS = Reg::R8;
+    static constexpr Reg FALSE_BITS = Reg::R9;
+    static constexpr Reg NIL_BITS = Reg::R10;
+
+    const Chunk &chunk;
+    Assembler assembler;
+
+    // the code of every instruction, and the exits to the interpreter of the instructions that have guards
+    vector<Assembler::Label> instructions;
+    vector<Assembler::Label> exits;
+    vector<bool> guarded;
+
+    static int32_t address(uint16_t reg) {
+        return int32_t(reg) * int32_t(sizeof(Value));
+    }
+
+    static uint64_t bits(const Value &value) {
+        return value.bits;
+    }
+
+    bool isNumber(uint16_t constant) const {
+        return chunk.constants[constant].isNumber();
+    }
+
+    bool compile(size_t index, const Instruction &instruction);
+
+    // leaves to the interpreter, which goes on with the instruction at index
+    void exit(size_t index);
+
+    // leaves to the interpreter at the instruction at index, unless the register holds a Number
+    void guardNumber(size_t index, Reg reg);
+
+    // loads a register that must hold a Number into an SSE register, through a general purpose one
+    void loadNumber(size_t index, Xmm dst, uint16_t reg, Reg through);
+    void loadConstant(Xmm dst, uint16_t constant);
+
+    // stores a Number from XMM0 into a register / a boolean for a condition of the flags
+    void storeNumber(uint16_t reg);
+    void storeBoolean(uint16_t reg, Condition condition);
+
+    // loads the register and sets the flags for the conditions BELOW_EQUAL: falsey, ABOVE: truthy
+    void testTruthy(uint16_t reg);
+};
+
+bool NativeCompiler::compile(vector<uint8_t> &code, vector<uint32_t> &entries) {
+    auto count = chunk.instructions.size();
+
+    for (size_t index = 0; index < count; ++index) {
+        instructions.push_back(assembler.label());
+        exits.push_back(assembler.label());
+    }
+
+    guarded.assign(count, false);
+
+    // the prologue: constants into their registers, then on to the instruction the caller passed the address of
+    assembler.move(NAN_BITS, Value::QNAN);
+    assembler.move(FALSE_BITS, bits(Value::boolean(false)));
+    assembler.move(NIL_BITS, bits(Value::nil()));
+    assembler.jump(Reg::RSI);
+
+    for (size_t index = 0; index < count; ++index) {
+        entries.push_back(assembler.offset());
+        assembler.bind(instructions[index]);
+
+        if (not compile(index, chunk.instructions[index])) {
+            return false;
+        }
+    }
+
+    for (size_t index = 0; index < count; ++index) {
+        if (guarded[index]) {
+            assembler.bind(exits[index]);
+            exit(index);
+        }
+    }
+
+    code = assembler.finish();
+    return true;
+}
+
+bool NativeCompiler::compile(size_t index, const Instruction &instruction) {
+    switch (instruction.op) {
+        case Op::MOVE:
+            assembler.load(Reg::RAX, SLOTS, address(instruction.b));
+            assembler.store(SLOTS, address(instruction.a), Reg::RAX);
+            return true;
+
+        case Op::LOAD_CONSTANT:
+            assembler.move(Reg::RAX, bits(chunk.constants[instruction.b]));
+            assembler.store(SLOTS, address(instruction.a), Reg::RAX);
+            return true;
+
+        case Op::LOAD_NIL:
+            assembler.store(SLOTS, address(instruction.a), NIL_BITS);
+            return true;
+
+        case Op::LOAD_BOOLEAN:
+            assembler.move(Reg::RAX, bits(Value::boolean(instruction.b != 0)));
+            assembler.store(SLOTS, address(instruction.a), Reg::RAX);
+            return true;
+
+        case Op::ADD: case Op::SUBTRACT: case Op::MULTIPLY: case Op::DIVIDE:
+        case Op::ADD_CONSTANT: case Op::SUBTRACT_CONSTANT: {
+            auto constant = instruction.op == Op::ADD_CONSTANT or instruction.op == Op::SUBTRACT_CONSTANT;
+
+            loadNumber(index, Xmm::XMM0, instruction.b, Reg::RAX);
+
+            if (not constant) {
+                loadNumber(index, Xmm::XMM1, instruction.c, Reg::RCX);
+            } else if (isNumber(instruction.c)) {
+                loadConstant(Xmm::XMM1, instruction.c);
+            } else {
+                // concatenation
+                return false;
+            }
+
+            switch (instruction.op) {
+                case Op::ADD: case Op::ADD_CONSTANT:
+                    assembler.addDouble(Xmm::XMM0, Xmm::XMM1);
+                    break;
+
+                case Op::SUBTRACT: case Op::SUBTRACT_CONSTANT:
+                    assembler.subtractDouble(Xmm::XMM0, Xmm::XMM1);
+                    break;
+
+                case Op::MULTIPLY:
+                    assembler.multiplyDouble(Xmm::XMM0, Xmm::XMM1);
+                    break;
+
+                default:
+                    assembler.divideDouble(Xmm::XMM0, Xmm::XMM1);
+            }
+
+            storeNumber(instruction.a);
+            return true;
+        }
+
+        case Op::GREATER: case Op::GREATER_EQUAL: case Op::LESS: case Op::LESS_EQUAL: {
+            loadNumber(index, Xmm::XMM0, instruction.b, Reg::RAX);
+            loadNumber(index, Xmm::XMM1, instruction.c, Reg::RCX);
+
+            // UCOMISD sets the flags like an unsigned comparison, and as "unordered" for NaN, which fails both ABOVE
+            // and ABOVE_EQUAL, so the comparisons test those with the operands in the right order
+            auto greater = instruction.op == Op::GREATER or instruction.op == Op::GREATER_EQUAL;
+            auto strict = instruction.op == Op::GREATER or instruction.op == Op::LESS;
+
+            if (greater) {
+                assembler.compareDouble(Xmm::XMM0, Xmm::XMM1);
+            } else {
+                assembler.compareDouble(Xmm::XMM1, Xmm::XMM0);
+            }
+
+            storeBoolean(instruction.a, strict ? Condition::ABOVE : Condition::ABOVE_EQUAL);
+            return true;
+        }
+
+        case Op::EQUAL: case Op::NOT_EQUAL: {
+            // other Values are left to the interpreter, which compares Strings by contents
+            loadNumber(index, Xmm::XMM0, instruction.b, Reg::RAX);
+            loadNumber(index, Xmm::XMM1, instruction.c, Reg::RCX);
+            assembler.compareDouble(Xmm::XMM0, Xmm::XMM1);
+
+            // equal unless unordered
+            if (instruction.op == Op::EQUAL) {
+                assembler.set(Condition::EQUAL, Reg::RAX);
+                assembler.set(Condition::NO_PARITY, Reg::RCX);
+                assembler.bitAnd(Reg::RAX, Reg::RCX);
+            } else {
+                assembler.set(Condition::NOT_EQUAL, Reg::RAX);
+                assembler.set(Condition::PARITY, Reg::RCX);
+                assembler.bitOr(Reg::RAX, Reg::RCX);
+            }
+
+            assembler.add(Reg::RAX, FALSE_BITS);
+            assembler.store(SLOTS, address(instruction.a), Reg::RAX);
+            return true;
+        }
+
+        case Op::NOT:
+            testTruthy(instruction.b);
+            assembler.set(Condition::BELOW_EQUAL, Reg::RAX);
+            assembler.add(Reg::RAX, FALSE_BITS);
+            assembler.store(SLOTS, address(instruction.a), Reg::RAX);
+            return true;
+
+        case Op::NEGATE:
+            assembler.load(Reg::RAX, SLOTS, address(instruction.b));
+            guardNumber(index, Reg::RAX);
+            assembler.move(Reg::RCX, Value::SIGN_BIT);
+            assembler.bitXor(Reg::RAX, Reg::RCX);
+            assembler.store(SLOTS, address(instruction.a), Reg::RAX);
+            return true;
+
+        case Op::JUMP:
+            assembler.jump(instructions[instruction.b]);
+            return true;
+
+        case Op::JUMP_IF_FALSE:
+            testTruthy(instruction.a);
+            assembler.jump(Condition::BELOW_EQUAL, instructions[instruction.b]);
+            return true;
+
+        case Op::JUMP_IF_TRUE:
+            testTruthy(instruction.a);
+            assembler.jump(Condition::ABOVE, instructions[instruction.b]);
+            return true;
+
+        case Op::JUMP_UNLESS_LESS: case Op::JUMP_UNLESS_LESS_CONSTANT: {
+            loadNumber(index, Xmm::XMM0, instruction.a, Reg::RAX);
+
+            if (instruction.op == Op::JUMP_UNLESS_LESS) {
+                loadNumber(index, Xmm::XMM1, instruction.b, Reg::RCX);
+            } else if (isNumber(instruction.b)) {
+                loadConstant(Xmm::XMM1, instruction.b);
+            } else {
+                return false;
+            }
+
+            // unless right > left, which includes NaN
+            assembler.compareDouble(Xmm::XMM1, Xmm::XMM0);
+            assembler.jump(Condition::BELOW_EQUAL, instructions[instruction.c]);
+            return true;
+        }
+
+        case Op::JUMP_UNLESS_EQUAL_CONSTANT: {
+            if (not isNumber(instruction.b)) {
+                return false;
+            }
+
+            // anything but a Number differs from a Number, no need to leave to the interpreter for that
+            assembler.load(Reg::RAX, SLOTS, address(instruction.a));
+            assembler.move(Reg::RDX, Reg::RAX);
+            assembler.bitAnd(Reg::RDX, NAN_BITS);
+            assembler.compare(Reg::RDX, NAN_BITS);
+            assembler.jump(Condition::EQUAL, instructions[instruction.c]);
+
+            assembler.move(Xmm::XMM0, Reg::RAX);
+            loadConstant(Xmm::XMM1, instruction.b);
+            assembler.compareDouble(Xmm::XMM0, Xmm::XMM1);
+            assembler.jump(Condition::NOT_EQUAL, instructions[instruction.c]);
+            assembler.jump(Condition::PARITY, instructions[instruction.c]);
+            return true;
+        }
+
+        case Op::RETURN:
+            // the interpreter pops the frame
+            exit(index);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void NativeCompiler::exit(size_t index) {
+    assembler.move32(Reg::RAX, static_cast<uint32_t>(index));
+    assembler.ret();
+}
+
+void NativeCompiler::guardNumber(size_t index, Reg reg) {
+    // a Value is a Number unless all bits of the quiet NaN are set
+    assembler.move(Reg::RDX, reg);
+    assembler.bitAnd(Reg::RDX, NAN_BITS);
+    assembler.compare(Reg::RDX, NAN_BITS);
+    assembler.jump(Condition::EQUAL, exits[index]);
+
+    guarded[index] = true;
+}
+
+void NativeCompiler::loadNumber(size_t index, Xmm dst, uint16_t reg, Reg through) {
+    assembler.load(through, SLOTS, address(reg));
+    guardNumber(index, through);
+    assembler.move(dst, through);
+}
+
+void NativeCompiler::loadConstant(Xmm dst, uint16_t constant) {
+    assembler.move(Reg::RCX, bits(chunk.constants[constant]));
+    assembler.move(dst, Reg::RCX);
+}
+
+void NativeCompiler::storeNumber(uint16_t reg) {
+    assembler.move(Reg::RAX, Xmm::XMM0);
+    assembler.store(SLOTS, address(reg), Reg::RAX);
+}
+
+void NativeCompiler::storeBoolean(uint16_t reg, Condition condition) {
+    // true is false + 1
+    assembler.set(condition, Reg::RAX);
+    assembler.add(Reg::RAX, FALSE_BITS);
+    assembler.store(SLOTS, address(reg), Reg::RAX);
+}
+
+void NativeCompiler::testTruthy(uint16_t reg) {
+    // nil and false are adjacent, see Value::isTruthy
+    assembler.load(Reg::RAX, SLOTS, address(reg));
+    assembler.subtract(Reg::RAX, NIL_BITS);
+    assembler.compare(Reg::RAX, int8_t{1});
+}
+
+// appends a line for the code to the map perf reads symbols of JIT-compiled code from
+static void registerSymbol(const uint8_t *code, size_t size, const string &name) {
+    static ofstream map {"/tmp/perf-" + to_string(getpid()) + ".map", ios::app};
+
+    map << hex << reinterpret_cast<uintptr_t>(code) << " " << size << dec << " lox:" << name << endl;
+}
+
+shared_ptr<NativeCode> compileNative(const Chunk &chunk, const string &name) {
+    vector<uint8_t> code;
+    vector<uint32_t> entries;
+
+    if (not NativeCompiler{chunk}.compile(code, entries)) {
+        return nullptr;
+    }
+
+    // written while writable, then made executable and read-only
+    auto memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+
+    memcpy(memory, code.data(), code.size());
+
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, code.size());
+        return nullptr;
+    }
+
+    auto native = make_shared<NativeCode>(static_cast<uint8_t*>(memory), code.size(), move(entries));
+    registerSymbol(static_cast<uint8_t*>(memory), code.size(), name);
+
+    return native;
+}
+
+#endif
@@ -0,0 +1,63 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_BASELINEJIT_H
+#define LOX_INTERPRETER_BASELINEJIT_H
+
+#include "vm/Chunk.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// how often register code has to be entered or jump backwards before it is compiled to machine code
+constexpr std::uint32_t JIT_THRESHOLD = 1000;
+
+// how often machine code may leave to the interpreter on a failed type guard before it is discarded
+constexpr std::uint32_t DEOPT_LIMIT = 100;
+
+/*
+ * Machine code compiled from the register code of a chunk, in memory mapped executable. It works on the registers of the
+ * frame in place, so the frame is up to date at every instruction and the code can be entered at any of them, on a call
+ * or at the back edge of a loop, and leave to the interpreter at any of them.
+ */
+class NativeCode {
+
+public:
+    NativeCode(std::uint8_t *memory, std::size_t size, std::vector<std::uint32_t> &&entries);
+    ~NativeCode();
+
+    NativeCode(const NativeCode&) = delete;
+    NativeCode& operator=(const NativeCode&) = delete;
+
+    // Runs the code from the given instruction on, in the frame with the given registers, up to an instruction it
+    // leaves to the interpreter: a return, or one whose operands aren't Numbers. Returns the index of that instruction.
+    std::uint32_t run(Value *slots, std::size_t index) const {
+        return reinterpret_cast<Entry>(memory)(slots, memory + entries[index]);
+    }
+
+private:
+    // the code starts with a prologue that sets up constants and jumps to the address given
+    using Entry = std::uint32_t (*)(Value *slots, const void *instruction);
+
+    std::uint8_t *memory;
+    std::size_t size;
+
+    // the offset of every instruction's code
+    std::vector<std::uint32_t> entries;
+};
+
+/*
+ * Compiles the register code of a chunk into x86-64 machine code, one template per instruction, and registers it under
+ * the given name in /tmp/perf-<pid>.map for profilers; the addresses of code that is dropped are never reused, so the
+ * map stays valid. Only functions that compute with numbers in their registers are compiled: instructions that access
+ * globals, cells or upvalues, call, create closures or print make the compiler give up and return nullptr, as does any
+ * platform other than x86-64.
+ */
+std::shared_ptr<NativeCode> compileNative(const Chunk &chunk, const std::string &name);
+
+
+#endif //LOX_INTERPRETER_BASELINEJIT_H
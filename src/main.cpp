@@ -5,9 +5,15 @@
 #include "parser/parser.h"
 #include "interpreter/Interpreter.h"
 #include "resolver/Resolver.h"
+#include "vm/Compiler.h"
+#include "vm/RegisterCompiler.h"
+#include "vm/VM.h"
+#include "closure/ClosureCompiler.h"
+#include "transpiler/Transpiler.h"
 
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sstream>
 
@@ -16,25 +22,140 @@ using namespace std;
 void runFile(const string &path);
 void runPrompt();
 void run(const string &source);
+void printStatistics();
 
 static Interpreter interpreter {};
 
 #include "interpreter/Callable.h"
+#include "interpreter/CallSite.h"
+
+// Command line flags
+static bool statistics = false;
+static bool profile = false;
+static bool superinstructions = true;
+
+// whether to write the script as C instead of running it
+static bool emitC = false;
+
+// the engine selected with --engine: tree, closure, vm or register
+static string engine = "register";
+
+// the JIT selected with --jit: off or baseline
+static string jit = "off";
+
+// the VM or the closure engine, unless the tree-walking interpreter executes the program
+static unique_ptr<VM> vm;
+static unique_ptr<ClosureEngine> closures;
+
+void usage();
+bool option(const string &argument, const string &name, string &value);
 
 int main(int argc, char *argv[]) {
+    vector<string> arguments;
+
+    for (int i = 1; i < argc; ++i) {
+        string argument {argv[i]};
+        string value;
 
-    if (argc == 1) {
+        try {
+            if (argument == "--stats") {
+                statistics = true;
+                CallSite::recording = true;
+            } else if (argument == "--opcode-pairs") {
+                profile = true;
+            } else if (argument == "--no-superinstructions") {
+                superinstructions = false;
+            } else if (argument == "--emit-c") {
+                emitC = true;
+            } else if (argument == "--gc-stress") {
+                interpreter.heap.stress = true;
+            } else if (option(argument, "--gc-threshold", value)) {
+                interpreter.heap.minimumThreshold = stoul(value);
+            } else if (option(argument, "--gc-growth", value)) {
+                interpreter.heap.growth = stod(value);
+            } else if (option(argument, "--gc-nursery", value)) {
+                interpreter.heap.nurserySize = stoul(value);
+            } else if (option(argument, "--gc-max-pause", value)) {
+                interpreter.heap.maxPause = chrono::microseconds{stoul(value)};
+            } else if (option(argument, "--engine", value)) {
+                if (value != "tree" and value != "closure" and value != "vm" and value != "register") {
+                    usage();
+                }
+
+                engine = value;
+            } else if (option(argument, "--jit", value)) {
+                if (value != "off" and value != "baseline") {
+                    usage();
+                }
+
+                jit = value;
+            } else if (argument.rfind("--", 0) == 0) {
+                usage();
+            } else {
+                arguments.push_back(move(argument));
+            }
+        } catch (const logic_error &e) {
+            // malformed number
+            usage();
+        }
+    }
+
+    if (engine == "closure") {
+        closures = make_unique<ClosureEngine>(interpreter);
+    } else if (engine != "tree") {
+        vm = make_unique<VM>(interpreter);
+        vm->profiling = profile;
+
+        // machine code doesn't count instructions
+        vm->jit = jit == "baseline" and not profile;
+    }
+
+    if (arguments.empty() and not emitC) {
         runPrompt();
-    } else if (argc == 2) {
-        runFile(string {argv[1]});
+    } else if (arguments.size() == 1) {
+        runFile(arguments.front());
     } else  {
-        cout << "Usage: lox [script]\n";
-        exit(EXIT_FAILURE);
+        usage();
     }
 
     return EXIT_SUCCESS;
 }
 
+void usage() {
+    cout << "Usage: lox [options] [script]\n"
+         << "\n"
+         << "Options:\n"
+         << "  --engine=<tree|closure|vm|register>\n"
+         << "                          execute the syntax tree directly, compile it to closures, or compile it\n"
+         << "                          to bytecode for a stack or a register machine (default); programs with\n"
+         << "                          functions too large for 16-bit operands run in the tree walker\n"
+         << "  --jit=<off|baseline>    compile hot numeric functions of the register VM to machine code\n"
+         << "                          (x86-64 only, default off)\n"
+         << "  --emit-c                write the script as a C program to standard output instead of running it\n"
+         << "                          (see src/transpiler/Runtime.h)\n"
+         << "  --stats                 print runtime statistics on exit\n"
+         << "  --opcode-pairs          count pairs of consecutive register VM instructions, print them on exit\n"
+         << "  --no-superinstructions  don't fuse common register VM instruction sequences\n"
+         << "  --gc-nursery=<bytes>    size of the young generation (default 256 KiB)\n"
+         << "  --gc-threshold=<bytes>  minimum old generation size before it is collected\n"
+         << "  --gc-growth=<factor>    old generation growth factor between collections\n"
+         << "  --gc-max-pause=<us>     collect the old generation incrementally, in steps of at most <us>\n"
+         << "                          microseconds (default 0: all at once)\n"
+         << "  --gc-stress             collect garbage before every allocation\n";
+
+    exit(EXIT_FAILURE);
+}
+
+// matches arguments of the form `<name>=<value>`
+bool option(const string &argument, const string &name, string &value) {
+    if (argument.rfind(name + "=", 0) != 0) {
+        return false;
+    }
+
+    value = argument.substr(name.size() + 1);
+    return true;
+}
+
 void runFile(const string &path) {
     ifstream file {path};
     string input {istreambuf_iterator<char> {file}, istreambuf_iterator<char> {}};
@@ -43,8 +164,11 @@ void runFile(const string &path) {
         run(input);
     } catch (const LoxError &e) {
         cerr << e.what() << "\n";
+        printStatistics();
         exit(EXIT_FAILURE);
     }
+
+    printStatistics();
 }
 
 void runPrompt() {
@@ -69,7 +193,59 @@ void run(const string &source) {
     auto tokens = scan(source);
     auto statements = parse(move(tokens));
 
-    resolve(statements, interpreter);
+    auto slots = resolve(statements);
+
+    if (emitC) {
+        transpile(statements, slots, cout);
+        return;
+    }
+
+    if (engine == "register" or engine == "vm") {
+        shared_ptr<Chunk> script;
 
-    interpreter.interpret(statements);
+        try {
+            if (engine == "register") {
+                script = compileRegisters(statements, slots, *interpreter.globals, superinstructions);
+            } else {
+                script = compile(statements, slots, *interpreter.globals);
+            }
+        } catch (const CompileError &e) {
+            // A function has more instructions or constants than 16-bit operands address. Nothing has run yet, and the
+            // tree-walking Interpreter shares the globals and calls the functions the VM defined before, so it takes
+            // the program over.
+            if (statistics) {
+                cerr << e.what() << " Running it in the tree-walking interpreter.\n";
+            }
+
+            interpreter.interpret(statements, slots);
+            return;
+        }
+
+        if (engine == "register") {
+            vm->interpretRegisters(*script);
+        } else {
+            vm->interpret(*script, slots);
+        }
+    } else if (engine == "closure") {
+        auto script = compileClosures(statements, slots, *closures);
+        closures->interpret(*script, slots);
+    } else {
+        interpreter.interpret(statements, slots);
+    }
+}
+
+void printStatistics() {
+    if (vm and profile) {
+        vm->printProfile(cerr);
+    }
+
+    if (not statistics) {
+        return;
+    }
+
+    interpreter.heap.printStatistics(cerr);
+
+    if (engine == "tree" or engine == "register") {
+        printCallSites(cerr);
+    }
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "data/statement.h"
 
 #include <sstream>
+#include <functional>
 
 using namespace std;
 
@@ -17,7 +17,8 @@
 std::vector<Statement_ptr> parse(std::vector<Token_ptr> &&tokens);
 
 struct ParseError : LoxError {
-    const Token &token;
+    // copied, since the error outlives the syntax tree it was raised in
+    const Token token;
     const std::string message;
 
     ParseError(const Token &token, std::string message);
@@ -8,13 +8,18 @@ using namespace std;
 
 using FunctionType = Resolver::FunctionType;
 
-void resolve(const std::vector<Statement_ptr> &statements, Interpreter &interpreter) {
-    Resolver resolver{interpreter};
+size_t resolve(const std::vector<Statement_ptr> &statements) {
+    Resolver resolver;
     resolver.resolve(statements);
+
+    return resolver.frameSize();
 }
 
-Resolver::Resolver(Interpreter &interpreter)
-    : interpreter{interpreter} {}
+Resolver::Resolver() : functions{{nullptr, 0, 0, 0}} {}
+
+size_t Resolver::frameSize() const {
+    return static_cast<size_t>(functions.front().frameSize);
+}
 
 void Resolver::resolve(const vector<Statement_ptr> &statements) {
     for (const auto &statement : statements) {
@@ -41,7 +46,7 @@ void Resolver::visit(Print &statement) {
 }
 
 void Resolver::visit(Var &statement) {
-    declare(*statement.name);
+    declare(*statement.name, &statement.access, statement.slot);
 
     if (statement.initializer) {
         resolve(*statement.initializer);
@@ -71,7 +76,7 @@ void Resolver::visit(While &statement) {
 }
 
 void Resolver::visit(Function &statement) {
-    declare(*statement.name);
+    declare(*statement.name, &statement.access, statement.slot);
     define(*statement.name);
 
     resolveFunction(statement, FunctionType::FUNCTION);
@@ -84,6 +89,7 @@ void Resolver::visit(Return &statement) {
 
     if (statement.value) {
         resolve(*statement.value);
+        statement.tailCall = dynamic_cast<Call*>(statement.value.get());
     }
 }
 
@@ -118,18 +124,18 @@ void Resolver::visit(Variable &expression) {
         auto &scope = scopes.back();
         auto found = scope.find(expression.name->lexeme);
 
-        if (found != scope.end() and not found->second) {
+        if (found != scope.end() and not found->second.defined) {
             throw ResolverError(expression.name, "Cannot read local variable in its own initializer");
         }
 
     }
 
-    resolveLocal(expression, *expression.name);
+    resolveLocal(*expression.name, expression.access, expression.slot);
 }
 
 void Resolver::visit(Assign &expression) {
     resolve(*expression.value);
-    resolveLocal(expression, *expression.name);
+    resolveLocal(*expression.name, expression.access, expression.slot);
 }
 
 void Resolver::visit(Call &expression) {
@@ -147,10 +153,24 @@ void Resolver::beginScope() {
 }
 
 void Resolver::endScope() {
+    auto &scope = scopes.back();
+
+    for (auto &variable : scope) {
+        auto &local = variable.second;
+
+        if (local.captured) {
+            for (auto access : local.accesses) {
+                *access = Access::CELL;
+            }
+        }
+    }
+
+    // the slots of this scope's variables are free again for the next scope
+    functions.back().live -= static_cast<int>(scope.size());
     scopes.pop_back();
 }
 
-void Resolver::declare(const Token &name) {
+void Resolver::declare(const Token &name, Access *access, int &slot) {
     if (scopes.empty()) {
         return;
     }
@@ -162,7 +182,17 @@ void Resolver::declare(const Token &name) {
         throw ResolverError(make_shared<Token>(name), "Variable with this name already declared in this scope.");
     }
 
-    scope[name.lexeme] = false;
+    // variables are declared in order, so the next free slot is the number of variables in the enclosing scopes
+    auto &function = functions.back();
+    slot = function.live++;
+    function.frameSize = max(function.frameSize, function.live);
+
+    auto &local = scope[name.lexeme] = {slot, false, false, {}};
+
+    if (access) {
+        *access = Access::LOCAL;
+        local.accesses.push_back(access);
+    }
 }
 
 
@@ -172,42 +202,108 @@ void Resolver::define(const Token &name) {
     }
 
     auto &scope = scopes.back();
-    scope[name.lexeme] = true;
+    scope[name.lexeme].defined = true;
 }
 
 
-void Resolver::resolveLocal(Expression &expression, const Token &name) {
+void Resolver::resolveLocal(const Token &name, Access &access, int &slot) {
     // stack::size() returns size_t which might underflow
     int size = static_cast<int>(scopes.size());
+    int first = static_cast<int>(functions.back().scopes);
 
-    // Start at innermost scope, working outwards
-    for (auto i = size - 1; i >= 0; i--) {
+    // Start at innermost scope, working outwards through the scopes of the current function
+    for (auto i = size - 1; i >= first; i--) {
         auto &scope = scopes[i];
 
         // if name can be resolved in the current scope
-        if (scope.find(name.lexeme) != scope.end()) {
-            interpreter.resolve(expression, size - 1 - i);
+        auto local = scope.find(name.lexeme);
+
+        if (local != scope.end()) {
+            access = Access::LOCAL;
+            slot = local->second.slot;
+            local->second.accesses.push_back(&access);
             return;
         }
     }
 
-    // Not found. Assume it's global
+    // Then look for a local of an enclosing function. Not found: assume it's global
+    auto upvalue = resolveUpvalue(name.lexeme, functions.size() - 1);
+
+    if (upvalue >= 0) {
+        access = Access::UPVALUE;
+        slot = upvalue;
+    }
+}
+
+int Resolver::resolveUpvalue(const string &name, size_t function) {
+    if (function == 0) {
+        return -1;
+    }
+
+    auto &enclosing = functions[function - 1];
+    auto &current = functions[function];
+
+    for (auto i = current.scopes; i-- > enclosing.scopes;) {
+        auto local = scopes[i].find(name);
+
+        if (local != scopes[i].end()) {
+            local->second.captured = true;
+            return addUpvalue(*current.function, true, local->second.slot);
+        }
+    }
+
+    // a local further out: the enclosing function captures it as well and passes it on
+    auto upvalue = resolveUpvalue(name, function - 1);
+
+    if (upvalue >= 0) {
+        return addUpvalue(*current.function, false, upvalue);
+    }
+
+    return -1;
+}
+
+int Resolver::addUpvalue(Function &function, bool local, int index) {
+    auto &upvalues = function.upvalues;
+
+    for (size_t i = 0; i < upvalues.size(); i++) {
+        if (upvalues[i].local == local and upvalues[i].index == index) {
+            return static_cast<int>(i);
+        }
+    }
+
+    upvalues.push_back({local, index});
+    return static_cast<int>(upvalues.size() - 1);
 }
 
-void Resolver::resolveFunction(const Function &function, const FunctionType &type) {
+void Resolver::resolveFunction(Function &function, const FunctionType &type) {
     FunctionType enclosingFunction = currentFunction;
     currentFunction = type;
 
+    functions.push_back({&function, scopes.size(), 0, 0});
     beginScope();
 
+    // parameters occupy the first slots, in order, where the caller leaves the arguments
     for (const auto &parameter : function.parameters) {
-        declare(*parameter);
+        int slot;
+        declare(*parameter, nullptr, slot);
         define(*parameter);
     }
 
     resolve(function.body);
+
+    for (const auto &parameter : function.parameters) {
+        auto &local = scopes.back()[parameter->lexeme];
+
+        if (local.captured) {
+            function.cells.push_back(local.slot);
+        }
+    }
+
     endScope();
 
+    function.frameSize = static_cast<size_t>(functions.back().frameSize);
+    functions.pop_back();
+
     currentFunction = enclosingFunction;
 }
 
@@ -7,22 +7,32 @@
 
 #include <data/expression.h>
 #include <data/statement.h>
-#include <interpreter/Interpreter.h>
 #include <error.h>
 
+#include <cstddef>
+#include <string>
 #include <vector>
 #include <unordered_map>
 
-void resolve(const std::vector<Statement_ptr> &statements, Interpreter &interpreter);
+// resolves a program and returns the number of slots its top-level frame needs for the locals of top-level blocks
+std::size_t resolve(const std::vector<Statement_ptr> &statements);
 
+/*
+ * Determines where each variable lives. Globals are looked up by name at runtime. Locals get a slot in the frame of
+ * the function they are declared in (or the top-level frame), unless a nested function captures them: those are
+ * boxed in a Cell, which the frame slot holds and the closure shares as an upvalue.
+ */
 class Resolver : public ExpressionVisitor, StatementVisitor {
 public:
-    explicit Resolver(Interpreter &interpreter);
+    Resolver();
 
     void resolve(const std::vector<Statement_ptr> &statements);
     void resolve(Statement &statement);
     void resolve(Expression &expression);
 
+    // the number of slots the top-level frame needs for the locals of top-level blocks
+    std::size_t frameSize() const;
+
     // Member functions for Statement visitor interface
     void visit(ExpressionStatement &statement) override;
     void visit(Print &statement) override;
@@ -53,17 +63,50 @@ private:
     void beginScope();
     void endScope();
 
-    void declare(const Token &name);
+    // sets access and slot for a new variable in the current scope; access may be nullptr for parameters
+    void declare(const Token &name, Access *access, int &slot);
     void define(const Token &name);
 
-    void resolveLocal(Expression &expression, const Token &name);
-    void resolveFunction(const Function &function, const FunctionType &type);
+    // finds the variable name refers to and stores how to access it, leaving access untouched for globals
+    void resolveLocal(const Token &name, Access &access, int &slot);
+    void resolveFunction(Function &function, const FunctionType &type);
+
+    // returns the index of the upvalue of functions[function] that refers to name, or -1 if it is a global
+    int resolveUpvalue(const std::string &name, std::size_t function);
+    static int addUpvalue(Function &function, bool local, int index);
+
+    struct Local {
+        // index of the variable in its function's frame
+        int slot;
 
-    Interpreter &interpreter;
+        // whether it has been initialized completely (yet)
+        bool defined;
+
+        // whether a nested function refers to it, so it must live in a Cell
+        bool captured;
+
+        // the declaration and uses within its own function, which become CELL accesses if the variable is captured
+        std::vector<Access*> accesses;
+    };
 
     // each element in the stack is a map representing a single block scope; the key is the name of an object in the
-    // scope, its associated value indicates whether it has been initialized completely (yet).
-    std::vector<std::unordered_map<std::string, bool>> scopes;
+    // scope, its associated value describes the variable.
+    std::vector<std::unordered_map<std::string, Local>> scopes;
+
+    struct FunctionScope {
+        // nullptr for the top level
+        Function *function;
+
+        // index of the first scope belonging to this function
+        std::size_t scopes;
+
+        // slots in use by the scopes currently open, and the most ever used at once
+        int live;
+        int frameSize;
+    };
+
+    // the functions being resolved, innermost last
+    std::vector<FunctionScope> functions;
 
     // Indicator that tracks whether we are currently inside a function or not
     Resolver::FunctionType currentFunction = Resolver::FunctionType::NONE;
@@ -0,0 +1,333 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "Runtime.h"
+
+#include "interpreter/Interpreter.h"
+#include "interpreter/Callable.h"
+#include "interpreter/Cell.h"
+#include "interpreter/Globals.h"
+#include "data/statement.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/*
+ * The state of a compiled program: an Interpreter, for its heap, globals and natives, and a stack of frames like the
+ * ClosureEngine's, which it registers with the heap as roots.
+ */
+class Runtime final : public RootSet {
+
+public:
+    // Values, enough for thousands of nested calls
+    static constexpr size_t STACK_SIZE = 256 * 1024;
+
+    // nested calls also nest on the C stack, a few hundred bytes each
+    static constexpr int MAX_CALLS = 10000;
+
+    Interpreter interpreter;
+
+    // frames point into the stack, so it never grows
+    vector<Value> stack;
+    Value *top;
+
+    // whether the body that just returned made a tail call to a Lox function
+    bool tailCall = false;
+
+    // the number of calls to Lox functions in progress
+    int calls = 0;
+
+    bool statistics = false;
+
+    // the names of globals by index, for error messages
+    vector<string> globalNames;
+
+    // the declarations of compiled functions, created with their first closure
+    unordered_map<const LoxFunction*, shared_ptr<Function>> declarations;
+
+    Runtime() : stack(STACK_SIZE), top{stack.data()} {
+        interpreter.heap.addRoots(this);
+    }
+
+    ~Runtime() {
+        interpreter.heap.removeRoots(this);
+    }
+
+    Runtime(const Runtime&) = delete;
+    Runtime& operator=(const Runtime&) = delete;
+
+    void markRoots(Heap &heap) override {
+        for (auto value = stack.data(); value < top; ++value) {
+            heap.mark(*value);
+        }
+    }
+};
+
+Runtime *runtime;
+
+// LoxValues are the bits of Values
+Value value(LoxValue bits) {
+    return Value::fromBits(bits);
+}
+
+LoxValue bits(Value value) {
+    return value.toBits();
+}
+
+// the stack holds Values, which compiled code accesses as LoxValues
+Value* frame(const LoxValue *slots) {
+    return reinterpret_cast<Value*>(const_cast<LoxValue*>(slots));
+}
+
+void checkCall(const Value &callee, int count, int line) {
+    auto callable = callee.is<Callable>() ? callee.as<Callable>() : nullptr;
+
+    if (not callable) {
+        loxError(line, "Can only call functions and classes.");
+    }
+
+    if (count != callable->arity()) {
+        auto message = "Expected " + to_string(callable->arity()) + " arguments but got " + to_string(count) + ".";
+        loxError(line, message.c_str());
+    }
+}
+
+void printStatistics() {
+    if (runtime->statistics) {
+        runtime->interpreter.heap.printStatistics(cerr);
+    }
+}
+
+}
+
+// Startup and shutdown
+
+LoxValue* loxStart(int argc, char **argv, int stackSize) {
+    assert(bits(Value::nil()) == LOX_NIL and bits(Value::boolean(false)) == LOX_FALSE
+           and bits(Value::boolean(true)) == LOX_TRUE and "Runtime.h must agree with Value.h");
+
+    runtime = new Runtime;
+
+    for (int i = 1; i < argc; ++i) {
+        string argument {argv[i]};
+
+        if (argument == "--stats") {
+            runtime->statistics = true;
+        } else if (argument == "--gc-stress") {
+            runtime->interpreter.heap.stress = true;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--stats] [--gc-stress]\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // the top-level frame has no closure below it
+    auto slots = runtime->stack.data() + 1;
+    runtime->top = slots + stackSize;
+
+    return reinterpret_cast<LoxValue*>(slots);
+}
+
+int loxFinish() {
+    printStatistics();
+
+    delete runtime;
+    runtime = nullptr;
+
+    return EXIT_SUCCESS;
+}
+
+void loxBindGlobals(int *indices, const char *const *names, int count) {
+    auto &globals = *runtime->interpreter.globals;
+    auto &globalNames = runtime->globalNames;
+
+    for (int i = 0; i < count; ++i) {
+        indices[i] = globals.bind(names[i]);
+
+        globalNames.resize(max(globalNames.size(), size_t(indices[i]) + 1));
+        globalNames[indices[i]] = names[i];
+    }
+}
+
+LoxValue loxString(const char *characters, size_t length) {
+    return bits(String::NewSymbol({characters, length}));
+}
+
+// Runtime errors
+
+void loxError(int line, const char *message) {
+    cerr << LoxError::report(line, "", message) << "\n";
+    printStatistics();
+
+    exit(EXIT_FAILURE);
+}
+
+void loxArithmeticError(int line) {
+    loxError(line, "Operands of arithmetic operation (+, -, *, /) must be of type Number.");
+}
+
+void loxComparisonError(int line) {
+    loxError(line, "Operands of arithmetic comparison (>, >=, <, <=) must be of type Number.");
+}
+
+void loxNegationError(int line) {
+    loxError(line, "Operand of unary minus (-) must be of type Number.");
+}
+
+// Operators on boxed Values
+
+LoxValue loxAddObjects(LoxValue left, LoxValue right, int line) {
+    auto handler = plusHandlers[size_t(kindOf(value(left)))][size_t(kindOf(value(right)))];
+
+    if (not handler) {
+        loxError(line, plusError(value(left)).c_str());
+    }
+
+    return bits(handler(value(left), value(right)));
+}
+
+int loxEqual(LoxValue left, LoxValue right) {
+    return value(left) == value(right);
+}
+
+void loxPrint(LoxValue value) {
+    cout << ::value(value) << "\n";
+}
+
+// Variables
+
+LoxValue loxGetGlobal(int index, int line) {
+    auto global = runtime->interpreter.globals->find(index);
+
+    if (not global) {
+        loxError(line, ("Undefined variable \'" + runtime->globalNames[index] + "\'.").c_str());
+    }
+
+    return bits(*global);
+}
+
+void loxSetGlobal(int index, LoxValue value, int line) {
+    if (not runtime->interpreter.globals->replace(index, ::value(value))) {
+        loxError(line, ("Undefined variable \'" + runtime->globalNames[index] + "\'.").c_str());
+    }
+}
+
+void loxDefineGlobal(int index, LoxValue value) {
+    runtime->interpreter.globals->define(index, ::value(value));
+}
+
+LoxValue loxNewCell(LoxValue value) {
+    return bits(Cell::New(::value(value)));
+}
+
+LoxValue loxGetCell(LoxValue cell) {
+    return bits(value(cell).as<Cell>()->get());
+}
+
+void loxSetCell(LoxValue cell, LoxValue value) {
+    ::value(cell).as<Cell>()->set(::value(value));
+}
+
+LoxValue loxGetUpvalue(const LoxValue *slots, int index) {
+    return bits(frame(slots)[-1].as<FunctionObject>()->upvalues()[index]->get());
+}
+
+void loxSetUpvalue(const LoxValue *slots, int index, LoxValue value) {
+    frame(slots)[-1].as<FunctionObject>()->upvalues()[index]->set(::value(value));
+}
+
+// Functions
+
+LoxValue loxClosure(const LoxFunction *function, const LoxValue *slots) {
+    auto &declaration = runtime->declarations[function];
+
+    // FunctionObjects capture their upvalues, print and take arguments as their declaration says
+    if (not declaration) {
+        vector<Token_ptr> parameters;
+
+        for (int i = 0; i < function->arity; ++i) {
+            parameters.push_back(Token::New(TokenType::IDENTIFIER, "", 0));
+        }
+
+        declaration = Function::New(Token::New(TokenType::IDENTIFIER, function->name, 0), move(parameters), {});
+        declaration->native = function;
+
+        for (int i = 0; i < function->upvalueCount; ++i) {
+            declaration->upvalues.push_back({function->upvalues[i].local != 0, function->upvalues[i].index});
+        }
+    }
+
+    auto enclosing = frame(slots)[-1];
+    auto closure = enclosing.is<FunctionObject>() ? enclosing.as<FunctionObject>() : nullptr;
+
+    return bits(FunctionObject::New(declaration, frame(slots), closure));
+}
+
+LoxValue loxCall(LoxValue *base, int count, int line) {
+    auto callee = frame(base);
+    checkCall(*callee, count, line);
+
+    if (callee->is<Native>()) {
+        return bits(callee->as<Native>()->invoke(runtime->interpreter, callee + 1));
+    }
+
+    if (runtime->calls == Runtime::MAX_CALLS) {
+        loxError(line, "Stack overflow.");
+    }
+
+    auto &stack = runtime->stack;
+    auto slots = callee + 1;
+    auto previous = runtime->top;
+    ++runtime->calls;
+
+    // tail calls run in the same frame, one after another
+    while (true) {
+        auto &function = *slots[-1].as<FunctionObject>()->declaration->native;
+        auto end = slots + function.stackSize;
+
+        if (end > stack.data() + stack.size()) {
+            loxError(line, "Stack overflow.");
+        }
+
+        // The locals after the parameters start out nil. The caller's slots above the frame stay roots: they become
+        // the caller's again once the call returns, and mustn't refer to objects collected in the meantime.
+        fill(slots + function.arity, end, Value::nil());
+        runtime->top = max(end, previous);
+
+        auto result = function.body(reinterpret_cast<LoxValue*>(slots));
+
+        if (not runtime->tailCall) {
+            runtime->top = previous;
+            --runtime->calls;
+            return result;
+        }
+
+        runtime->tailCall = false;
+    }
+}
+
+LoxValue loxTailCall(LoxValue *slots, LoxValue *base, int count, int line) {
+    auto callee = frame(base);
+    checkCall(*callee, count, line);
+
+    if (callee->is<FunctionObject>()) {
+        // the callee and its arguments take the place of the current function and its frame
+        move(callee, callee + count + 1, frame(slots) - 1);
+        runtime->tailCall = true;
+
+        return LOX_NIL;
+    }
+
+    return loxCall(base, count, line);
+}
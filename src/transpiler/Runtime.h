@@ -0,0 +1,193 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_RUNTIME_H
+#define LOX_INTERPRETER_RUNTIME_H
+
+/*
+ * The C interface of the runtime library (libloxrt) that programs translated by the Transpiler link against. Behind it
+ * are the interpreter's own heap, objects and natives, so a compiled program allocates, collects, prints and fails
+ * exactly like `lox` does.
+ *
+ * Values have the NaN-boxed layout of Value.h; numbers, booleans and nil are tested and built inline below. Every Lox
+ * function compiles to a C function that runs in a frame on the runtime's stack: `slots` points at its parameters,
+ * followed by its locals and the temporaries of its expressions, and the closure being called is at slots[-1]. Values
+ * only survive a collection in a frame slot, so compiled code keeps every object it holds there.
+ *
+ * A runtime error prints its message like `lox` does and exits the program with status 1. Compiled programs accept
+ * `--stats` and `--gc-stress`, which work as for `lox`.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__)
+#define LOX_NORETURN __attribute__((noreturn))
+#else
+#define LOX_NORETURN
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint64_t LoxValue;
+
+// the bits of quiet NaNs, nil, false and true, as in Value.h
+#define LOX_QNAN ((LoxValue) 0x7ffc000000000000u)
+#define LOX_NIL (LOX_QNAN | 1)
+#define LOX_FALSE (LOX_QNAN | 2)
+#define LOX_TRUE (LOX_QNAN | 3)
+
+// the compiled body of a Lox function, returning the function's result
+typedef LoxValue (*LoxBody)(LoxValue *slots);
+
+// a variable a function captures, as in Function::Upvalue
+typedef struct LoxUpvalue {
+    int local;
+    int index;
+} LoxUpvalue;
+
+// a function declaration, compiled
+typedef struct LoxFunction {
+    const char *name;
+    int arity;
+
+    // the number of slots a call needs
+    int stackSize;
+
+    int upvalueCount;
+    const LoxUpvalue *upvalues;
+
+    LoxBody body;
+} LoxFunction;
+
+
+// Startup and shutdown
+
+// parses the runtime's options and returns the top-level frame, with the given number of slots
+LoxValue* loxStart(int argc, char **argv, int stackSize);
+
+// returns the exit status of a program that ran to its end
+int loxFinish(void);
+
+// stores the index of each named global in indices
+void loxBindGlobals(int *indices, const char *const *names, int count);
+
+// the String of a literal, which is kept alive for good
+LoxValue loxString(const char *characters, size_t length);
+
+
+// Runtime errors
+
+LOX_NORETURN void loxError(int line, const char *message);
+LOX_NORETURN void loxArithmeticError(int line);
+LOX_NORETURN void loxComparisonError(int line);
+LOX_NORETURN void loxNegationError(int line);
+
+
+// Numbers, booleans and nil
+
+static inline int loxIsNumber(LoxValue value) {
+    return (value & LOX_QNAN) != LOX_QNAN;
+}
+
+static inline double loxAsNumber(LoxValue value) {
+    double number;
+    memcpy(&number, &value, sizeof number);
+    return number;
+}
+
+static inline LoxValue loxNumber(double number) {
+    LoxValue value;
+    memcpy(&value, &number, sizeof value);
+    return value;
+}
+
+static inline LoxValue loxBoolean(int value) {
+    return value ? LOX_TRUE : LOX_FALSE;
+}
+
+// nil and false are adjacent, as in Value::isTruthy
+static inline int loxIsTruthy(LoxValue value) {
+    return value - LOX_NIL > 1;
+}
+
+// the Number an operand of -, *, / or of a comparison, or of unary minus, must be
+static inline double loxArithmeticOperand(LoxValue value, int line) {
+    if (!loxIsNumber(value)) {
+        loxArithmeticError(line);
+    }
+
+    return loxAsNumber(value);
+}
+
+static inline double loxComparisonOperand(LoxValue value, int line) {
+    if (!loxIsNumber(value)) {
+        loxComparisonError(line);
+    }
+
+    return loxAsNumber(value);
+}
+
+static inline double loxNegationOperand(LoxValue value, int line) {
+    if (!loxIsNumber(value)) {
+        loxNegationError(line);
+    }
+
+    return loxAsNumber(value);
+}
+
+
+// Operators on boxed Values
+
+// "+" on anything but two Numbers
+LoxValue loxAddObjects(LoxValue left, LoxValue right, int line);
+
+static inline LoxValue loxAdd(LoxValue left, LoxValue right, int line) {
+    if (loxIsNumber(left) && loxIsNumber(right)) {
+        return loxNumber(loxAsNumber(left) + loxAsNumber(right));
+    }
+
+    return loxAddObjects(left, right, line);
+}
+
+int loxEqual(LoxValue left, LoxValue right);
+
+void loxPrint(LoxValue value);
+
+
+// Variables
+
+LoxValue loxGetGlobal(int index, int line);
+void loxSetGlobal(int index, LoxValue value, int line);
+void loxDefineGlobal(int index, LoxValue value);
+
+LoxValue loxNewCell(LoxValue value);
+LoxValue loxGetCell(LoxValue cell);
+void loxSetCell(LoxValue cell, LoxValue value);
+
+// the upvalues of the function running in the given frame
+LoxValue loxGetUpvalue(const LoxValue *slots, int index);
+void loxSetUpvalue(const LoxValue *slots, int index, LoxValue value);
+
+
+// Functions
+
+// creates a closure of a function declared in the given frame
+LoxValue loxClosure(const LoxFunction *function, const LoxValue *slots);
+
+// calls the callee at base with the `count` values above it as arguments; the callee's frame starts above the callee
+LoxValue loxCall(LoxValue *base, int count, int line);
+
+// Returns such a call from the function running in the given frame. A Lox callee takes the place of the function and
+// its frame and runs once the function's body has returned, so tail calls don't nest.
+LoxValue loxTailCall(LoxValue *slots, LoxValue *base, int count, int line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //LOX_INTERPRETER_RUNTIME_H
@@ -0,0 +1,1003 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "Transpiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <regex>
+
+using namespace std;
+
+namespace {
+
+using Type = Transpiler::Type;
+
+// Records the declaration each access of a local refers to, and every value assigned to a local. Locals are in the
+// slots the Resolver assigned, which blocks that don't overlap share, so an access refers to the local that was last
+// declared in its slot.
+class Locals : public ExpressionVisitor, StatementVisitor {
+
+public:
+    Locals(unordered_map<const Expression*, const Var*> &declarations,
+           unordered_map<const Var*, vector<const Expression*>> &values)
+        : declarations{declarations}, values{values} {}
+
+    void run(const vector<Statement_ptr> &statements) {
+        for (const auto &statement : statements) {
+            statement->accept(*this);
+        }
+    }
+
+    void visit(ExpressionStatement &statement) override {
+        statement.expression->accept(*this);
+    }
+
+    void visit(Print &statement) override {
+        statement.expression->accept(*this);
+    }
+
+    void visit(Block &statement) override {
+        run(statement.statements);
+    }
+
+    void visit(Var &statement) override {
+        if (statement.initializer) {
+            statement.initializer->accept(*this);
+        }
+
+        if (statement.access == Access::LOCAL) {
+            declare(statement.slot, &statement);
+            values[&statement].push_back(statement.initializer.get());
+        } else if (statement.access == Access::CELL) {
+            declare(statement.slot, nullptr);
+        }
+    }
+
+    void visit(If &statement) override {
+        statement.condition->accept(*this);
+        statement.thenBranch->accept(*this);
+
+        if (statement.elseBranch) {
+            statement.elseBranch->accept(*this);
+        }
+    }
+
+    void visit(While &statement) override {
+        statement.condition->accept(*this);
+        statement.body->accept(*this);
+    }
+
+    void visit(Function &statement) override {
+        if (statement.access != Access::GLOBAL) {
+            declare(statement.slot, nullptr);
+        }
+
+        // the body has a frame of its own, with the parameters, which aren't declarations, in its first slots
+        vector<const Var*> enclosing;
+        swap(slots, enclosing);
+        run(statement.body);
+        swap(slots, enclosing);
+    }
+
+    void visit(Return &statement) override {
+        if (statement.value) {
+            statement.value->accept(*this);
+        }
+    }
+
+    void visit(Binary &expression) override {
+        expression.left->accept(*this);
+        expression.right->accept(*this);
+    }
+
+    void visit(Grouping &expression) override {
+        expression.content->accept(*this);
+    }
+
+    void visit(Literal &expression) override {}
+
+    void visit(Logical &expression) override {
+        expression.left->accept(*this);
+        expression.right->accept(*this);
+    }
+
+    void visit(Unary &expression) override {
+        expression.operand->accept(*this);
+    }
+
+    void visit(Variable &expression) override {
+        if (expression.access == Access::LOCAL) {
+            declarations[&expression] = declared(expression.slot);
+        }
+    }
+
+    void visit(Assign &expression) override {
+        expression.value->accept(*this);
+
+        if (expression.access == Access::LOCAL) {
+            auto declaration = declared(expression.slot);
+            declarations[&expression] = declaration;
+
+            if (declaration) {
+                values[declaration].push_back(expression.value.get());
+            }
+        }
+    }
+
+    void visit(Call &expression) override {
+        expression.callee->accept(*this);
+
+        for (const auto &argument : expression.arguments) {
+            argument->accept(*this);
+        }
+    }
+
+private:
+    unordered_map<const Expression*, const Var*> &declarations;
+    unordered_map<const Var*, vector<const Expression*>> &values;
+
+    // the declaration in each slot of the current frame, nullptr for parameters and anything but an uncaptured Var
+    vector<const Var*> slots;
+
+    void declare(int slot, const Var *declaration) {
+        slots.resize(max(slots.size(), size_t(slot) + 1));
+        slots[slot] = declaration;
+    }
+
+    const Var* declared(int slot) const {
+        return size_t(slot) < slots.size() ? slots[slot] : nullptr;
+    }
+};
+
+// the type of the C code an expression compiles to, given the locals that are Numbers
+class Typing : public ExpressionVisitor {
+
+public:
+    Typing(const unordered_map<const Expression*, const Var*> &declarations, const unordered_set<const Var*> &numbers)
+        : declarations{declarations}, numbers{numbers} {}
+
+    Type of(Expression &expression) {
+        expression.accept(*this);
+        return type;
+    }
+
+    void visit(Binary &expression) override {
+        switch (expression.token->type) {
+            case TokenType::PLUS:
+                // a concatenation, unless both operands are Numbers
+                type = of(*expression.left) == Type::NUMBER and of(*expression.right) == Type::NUMBER
+                    ? Type::NUMBER : Type::VALUE;
+                break;
+
+            case TokenType::MINUS: case TokenType::STAR: case TokenType::SLASH:
+                // or a runtime error
+                type = Type::NUMBER;
+                break;
+
+            default:
+                type = Type::BOOLEAN;
+        }
+    }
+
+    void visit(Grouping &expression) override {
+        expression.content->accept(*this);
+    }
+
+    void visit(Literal &expression) override {
+        switch (expression.token->type) {
+            case TokenType::NUMBER:
+                type = Type::NUMBER;
+                break;
+
+            case TokenType::TRUE: case TokenType::FALSE:
+                type = Type::BOOLEAN;
+                break;
+
+            default:
+                type = Type::VALUE;
+        }
+    }
+
+    void visit(Logical &expression) override {
+        type = Type::VALUE;
+    }
+
+    void visit(Unary &expression) override {
+        type = expression.token->type == TokenType::MINUS ? Type::NUMBER : Type::BOOLEAN;
+    }
+
+    void visit(Variable &expression) override {
+        type = number(expression, expression.access) ? Type::NUMBER : Type::VALUE;
+    }
+
+    void visit(Assign &expression) override {
+        type = number(expression, expression.access) ? Type::NUMBER : Type::VALUE;
+    }
+
+    void visit(Call &expression) override {
+        type = Type::VALUE;
+    }
+
+private:
+    const unordered_map<const Expression*, const Var*> &declarations;
+    const unordered_set<const Var*> &numbers;
+
+    Type type = Type::VALUE;
+
+    bool number(const Expression &expression, Access access) const {
+        if (access != Access::LOCAL) {
+            return false;
+        }
+
+        auto declaration = declarations.find(&expression);
+        return declaration != declarations.end() and numbers.count(declaration->second);
+    }
+};
+
+// Whether generated code refers to its frame, which it doesn't if it has no locals, temporaries or functions other
+// than doubles. Lox names can't be mistaken for it, since they all get a suffix.
+bool usesFrame(const string &code) {
+    return regex_search(code, regex{"\\bslots\\b"});
+}
+
+}
+
+void transpile(const vector<Statement_ptr> &statements, size_t slots, ostream &out) {
+    Transpiler{}.transpile(statements, slots, out);
+}
+
+void Transpiler::transpile(const vector<Statement_ptr> &statements, size_t slots, ostream &out) {
+    analyze(statements);
+
+    frameSize = slots;
+
+    for (const auto &statement : statements) {
+        compile(*statement);
+    }
+
+    out << "// Generated by lox --emit-c. Build it against the runtime library of a lox build, e.g.\n"
+        << "//\n"
+        << "//     cc -O2 -I<lox>/src program.c <build>/libloxrt.a -lstdc++ -lm -o program\n"
+        << "\n"
+        << "#include \"transpiler/Runtime.h\"\n"
+        << "\n";
+
+    if (not globals.empty()) {
+        out << "static int globals[" << globals.size() << "];\n"
+            << "static const char *const globalNames[] = {";
+
+        for (size_t i = 0; i < globals.size(); ++i) {
+            out << (i ? ", " : "") << stringLiteral(globals[i]);
+        }
+
+        out << "};\n\n";
+    }
+
+    if (not strings.empty()) {
+        out << "static LoxValue strings[" << strings.size() << "];\n\n";
+    }
+
+    if (not prototypes.empty()) {
+        out << prototypes << "\n" << descriptors << "\n" << definitions;
+    }
+
+    out << "int main(int argc, char **argv) {\n"
+        << "    " << (usesFrame(body) ? "LoxValue *slots = " : "") << "loxStart(argc, argv, " << frameSize + maxDepth << ");\n";
+
+    if (not globals.empty()) {
+        out << "    loxBindGlobals(globals, globalNames, " << globals.size() << ");\n";
+    }
+
+    for (size_t i = 0; i < strings.size(); ++i) {
+        out << "    strings[" << i << "] = loxString(" << stringLiteral(strings[i]) << ", " << strings[i].size()
+            << ");\n";
+    }
+
+    out << "\n" << body << "\n"
+        << "    return loxFinish();\n"
+        << "}\n";
+}
+
+// Analysis
+
+void Transpiler::analyze(const vector<Statement_ptr> &statements) {
+    Locals{declarations, values}.run(statements);
+
+    for (const auto &[access, declaration] : declarations) {
+        if (dynamic_cast<const Variable*>(access)) {
+            read.insert(declaration);
+        }
+    }
+
+    // assume all locals are Numbers, then rule out those assigned something else until the rest are consistent
+    for (const auto &[declaration, assigned] : values) {
+        numbers.insert(declaration);
+    }
+
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        for (const auto &[declaration, assigned] : values) {
+            auto always = all_of(assigned.begin(), assigned.end(), [&](const Expression *value) {
+                return value and typeOf(*value) == Type::NUMBER;
+            });
+
+            if (not always and numbers.erase(declaration)) {
+                changed = true;
+            }
+        }
+    }
+}
+
+Transpiler::Type Transpiler::typeOf(const Expression &expression) const {
+    // the visitor interface takes mutable nodes, but Typing doesn't change them
+    return Typing{declarations, numbers}.of(const_cast<Expression&>(expression));
+}
+
+// Helpers
+
+void Transpiler::emit(const string &line) {
+    body.append(4 * indentation, ' ').append(line).append("\n");
+}
+
+string Transpiler::unique(const string &name) {
+    return name + "_" + to_string(++names);
+}
+
+string Transpiler::slot(size_t index) {
+    return "slots[" + to_string(index) + "]";
+}
+
+size_t Transpiler::temporary() {
+    auto index = frameSize + depth++;
+    maxDepth = max(maxDepth, depth);
+
+    return index;
+}
+
+string Transpiler::global(const Token &name) {
+    auto [entry, inserted] = globalIndices.try_emplace(name.lexeme, globals.size());
+
+    if (inserted) {
+        globals.push_back(name.lexeme);
+    }
+
+    return "globals[" + to_string(entry->second) + "]";
+}
+
+string Transpiler::boxed(const Operand &operand) {
+    switch (operand.type) {
+        case Type::NUMBER:
+            return "loxNumber(" + operand.code + ")";
+
+        case Type::BOOLEAN:
+            return "loxBoolean(" + operand.code + ")";
+
+        default:
+            return operand.code;
+    }
+}
+
+string Transpiler::number(const Operand &operand, const char *check, int line) {
+    switch (operand.type) {
+        case Type::NUMBER:
+            return operand.code;
+
+        case Type::BOOLEAN:
+            // always fails
+            return string{check} + "(loxBoolean(" + operand.code + "), " + to_string(line) + ")";
+
+        default:
+            return string{check} + "(" + operand.code + ", " + to_string(line) + ")";
+    }
+}
+
+string Transpiler::condition(const Operand &operand) {
+    switch (operand.type) {
+        case Type::NUMBER:
+            // Numbers are truthy, but the operand may still fail
+            return operand.checked ? "(" + operand.code + ", 1)" : "1";
+
+        case Type::BOOLEAN:
+            return operand.code;
+
+        default:
+            return "loxIsTruthy(" + operand.code + ")";
+    }
+}
+
+string Transpiler::numberLiteral(double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof buffer, "%.17g", value);
+
+    // a double, not an int
+    string literal {buffer};
+    return literal.find_first_of(".e") == string::npos ? literal + ".0" : literal;
+}
+
+string Transpiler::stringLiteral(const string &value) {
+    string literal {"\""};
+
+    for (unsigned char character : value) {
+        if (character == '"' or character == '\\' or character == '?') {
+            // '?' for trigraphs
+            literal += '\\';
+            literal += character;
+        } else if (character < 0x20 or character >= 0x7f) {
+            char escape[8];
+            snprintf(escape, sizeof escape, "\\%03o", character);
+            literal += escape;
+        } else {
+            literal += character;
+        }
+    }
+
+    return literal + "\"";
+}
+
+Transpiler::Operand Transpiler::stabilize(const Operand &operand) {
+    switch (operand.type) {
+        case Type::NUMBER: {
+            auto name = unique("number");
+            emit("double " + name + " = " + operand.code + ";");
+            return {name, Type::NUMBER, true};
+        }
+
+        case Type::BOOLEAN: {
+            auto name = unique("condition");
+            emit("int " + name + " = " + operand.code + ";");
+            return {name, Type::BOOLEAN, true};
+        }
+
+        default: {
+            auto index = slot(temporary());
+            emit(index + " = " + operand.code + ";");
+            return {index, Type::VALUE, true};
+        }
+    }
+}
+
+// Compilation
+
+void Transpiler::compile(Statement &statement) {
+    // the temporaries of a statement are dead once it has run
+    auto start = depth;
+    statement.accept(*this);
+    depth = start;
+}
+
+Transpiler::Operand Transpiler::compile(Expression &expression) {
+    expression.accept(*this);
+    return operand;
+}
+
+void Transpiler::compileBranch(Statement &statement) {
+    if (auto block = dynamic_cast<Block*>(&statement)) {
+        for (const auto &nested : block->statements) {
+            compile(*nested);
+        }
+    } else {
+        compile(statement);
+    }
+}
+
+Transpiler::Operand Transpiler::compileAfter(Operand &left, Expression &right) {
+    // a variable may have to go into a temporary, which must come before the right operand's: a call in it puts the
+    // callee's frame right above the callee
+    auto reserved = left.type == Type::VALUE and not left.stable ? temporary() : 0;
+
+    auto start = body.size();
+    auto result = compile(right);
+
+    if (body.size() == start or (left.stable and not left.checked)) {
+        return result;
+    }
+
+    // the right operand runs code, which may assign the left one's variables or fail, so evaluate the left one first
+    auto code = body.substr(start);
+    body.resize(start);
+
+    if (left.type == Type::VALUE) {
+        emit(slot(reserved) + " = " + left.code + ";");
+        left = {slot(reserved), Type::VALUE, true};
+    } else {
+        left = stabilize(left);
+    }
+
+    body += code;
+    return result;
+}
+
+size_t Transpiler::compileCall(Call &call) {
+    auto callee = compile(*call.callee);
+
+    // a callee already in the topmost temporary, e.g. a global, stays there
+    auto base = frameSize + depth - 1;
+
+    if (depth == 0 or callee.code != slot(base)) {
+        base = temporary();
+        emit(slot(base) + " = " + boxed(callee) + ";");
+    }
+
+    for (size_t i = 0; i < call.arguments.size(); ++i) {
+        temporary();
+    }
+
+    for (size_t i = 0; i < call.arguments.size(); ++i) {
+        emit(slot(base + 1 + i) + " = " + boxed(compile(*call.arguments[i])) + ";");
+    }
+
+    return base;
+}
+
+string Transpiler::compileFunction(Function &function) {
+    auto name = unique(function.name->lexeme);
+
+    // the enclosing function is compiled further once this one is done
+    auto enclosingBody = move(body);
+    auto enclosingIndentation = indentation;
+    auto enclosingFrameSize = frameSize;
+    auto enclosingDepth = depth;
+    auto enclosingMaxDepth = maxDepth;
+
+    body.clear();
+    indentation = 1;
+    frameSize = function.frameSize;
+    depth = maxDepth = 0;
+
+    // captured parameters move into Cells before the body can create closures over them
+    for (auto cell : function.cells) {
+        emit(slot(cell) + " = loxNewCell(" + slot(cell) + ");");
+    }
+
+    for (const auto &statement : function.body) {
+        compile(*statement);
+    }
+
+    if (function.body.empty() or not dynamic_cast<Return*>(function.body.back().get())) {
+        emit("return LOX_NIL;");
+    }
+
+    prototypes += "static LoxValue " + name + "(LoxValue *slots);\n";
+
+    string upvalues = "NULL";
+
+    if (not function.upvalues.empty()) {
+        upvalues = name + "_upvalues";
+        descriptors += "static const LoxUpvalue " + upvalues + "[] = {";
+
+        for (size_t i = 0; i < function.upvalues.size(); ++i) {
+            auto &upvalue = function.upvalues[i];
+            descriptors += (i ? ", {" : "{") + to_string(upvalue.local) + ", " + to_string(upvalue.index) + "}";
+        }
+
+        descriptors += "};\n";
+    }
+
+    descriptors += "static const LoxFunction " + name + "_function = {" + stringLiteral(function.name->lexeme) + ", "
+        + to_string(function.parameters.size()) + ", " + to_string(frameSize + maxDepth) + ", "
+        + to_string(function.upvalues.size()) + ", " + upvalues + ", " + name + "};\n";
+
+    definitions += "static LoxValue " + name + "(LoxValue *slots) {\n" + (usesFrame(body) ? "" : "    (void) slots;\n")
+        + body + "}\n\n";
+
+    body = move(enclosingBody);
+    indentation = enclosingIndentation;
+    frameSize = enclosingFrameSize;
+    depth = enclosingDepth;
+    maxDepth = enclosingMaxDepth;
+
+    return name + "_function";
+}
+
+// Statements
+
+void Transpiler::visit(ExpressionStatement &statement) {
+    auto result = compile(*statement.expression);
+
+    // the value is unused, but the checks it made may still fail
+    if (result.checked) {
+        emit("(void) " + result.code + ";");
+    }
+}
+
+void Transpiler::visit(Print &statement) {
+    emit("loxPrint(" + boxed(compile(*statement.expression)) + ");");
+}
+
+void Transpiler::visit(Block &statement) {
+    emit("{");
+    ++indentation;
+
+    for (const auto &nested : statement.statements) {
+        compile(*nested);
+    }
+
+    --indentation;
+    emit("}");
+}
+
+void Transpiler::visit(Var &statement) {
+    auto value = statement.initializer ? compile(*statement.initializer) : Operand{"LOX_NIL", Type::VALUE, true};
+    auto line = statement.name->line;
+
+    switch (statement.access) {
+        case Access::GLOBAL:
+            emit("loxDefineGlobal(" + global(*statement.name) + ", " + boxed(value) + ");");
+            break;
+
+        case Access::LOCAL:
+            if (numbers.count(&statement)) {
+                auto name = unique(statement.name->lexeme);
+                doubles[&statement] = name;
+
+                emit("double " + name + " = " + number(value, "loxArithmeticOperand", line) + ";");
+
+                if (not read.count(&statement)) {
+                    emit("(void) " + name + ";");
+                }
+            } else {
+                emit(slot(statement.slot) + " = " + boxed(value) + ";");
+            }
+            break;
+
+        case Access::CELL:
+            // a new Cell on every execution, so closures created in different iterations of a loop don't share it
+            emit(slot(statement.slot) + " = loxNewCell(" + boxed(value) + ");");
+            break;
+
+        case Access::UPVALUE: ; // Unreachable, declarations are never upvalues
+    }
+}
+
+void Transpiler::visit(If &statement) {
+    emit("if (" + condition(compile(*statement.condition)) + ") {");
+
+    ++indentation;
+    compileBranch(*statement.thenBranch);
+    --indentation;
+
+    if (statement.elseBranch) {
+        emit("} else {");
+
+        ++indentation;
+        compileBranch(*statement.elseBranch);
+        --indentation;
+    }
+
+    emit("}");
+}
+
+void Transpiler::visit(While &statement) {
+    // the condition is compiled inside the loop, in case it has to run code
+    auto start = body.size();
+
+    ++indentation;
+    auto test = compile(*statement.condition);
+    --indentation;
+
+    if (body.size() == start) {
+        emit("while (" + condition(test) + ") {");
+    } else {
+        auto code = body.substr(start);
+        body.resize(start);
+
+        emit("for (;;) {");
+        body += code;
+
+        ++indentation;
+        emit("if (!" + condition(test) + ") {");
+        emit("    break;");
+        emit("}");
+        --indentation;
+    }
+
+    ++indentation;
+    compileBranch(*statement.body);
+    --indentation;
+
+    emit("}");
+}
+
+void Transpiler::visit(Function &statement) {
+    auto closure = "loxClosure(&" + compileFunction(statement) + ", slots)";
+
+    switch (statement.access) {
+        case Access::GLOBAL:
+            emit("loxDefineGlobal(" + global(*statement.name) + ", " + closure + ");");
+            break;
+
+        case Access::LOCAL:
+            emit(slot(statement.slot) + " = " + closure + ";");
+            break;
+
+        case Access::CELL:
+            // a function that refers to itself captures its own variable, so the Cell has to exist before the closure
+            emit(slot(statement.slot) + " = loxNewCell(LOX_NIL);");
+            emit("loxSetCell(" + slot(statement.slot) + ", " + closure + ");");
+            break;
+
+        case Access::UPVALUE: ; // Unreachable, declarations are never upvalues
+    }
+}
+
+void Transpiler::visit(Return &statement) {
+    if (statement.tailCall) {
+        auto &call = *statement.tailCall;
+        auto base = compileCall(call);
+
+        emit("return loxTailCall(slots, slots + " + to_string(base) + ", " + to_string(call.arguments.size()) + ", "
+             + to_string(call.paren->line) + ");");
+    } else if (statement.value) {
+        emit("return " + boxed(compile(*statement.value)) + ";");
+    } else {
+        emit("return LOX_NIL;");
+    }
+}
+
+// Expressions
+
+void Transpiler::visit(Binary &expression) {
+    auto left = compile(*expression.left);
+    auto right = compileAfter(left, *expression.right);
+
+    auto type = expression.token->type;
+    auto line = expression.token->line;
+    auto both = left.type == Type::NUMBER and right.type == Type::NUMBER;
+
+    // C doesn't order the evaluation of operands, so whatever may fail first runs in a statement of its own: the
+    // left operand, then the right one, then the operator's checks of their types
+    auto typeChecked = not both and type != TokenType::EQUAL_EQUAL and type != TokenType::BANG_EQUAL;
+
+    if (left.checked and (right.checked or typeChecked)) {
+        left = stabilize(left);
+    }
+
+    if (right.checked and typeChecked) {
+        right = stabilize(right);
+    }
+
+    auto stable = left.stable and right.stable;
+    auto checked = left.checked or right.checked;
+
+    // arithmetic and comparisons check and unbox operands that may be anything
+    auto arithmetic = [&](const string &op) {
+        auto code = "(" + number(left, "loxArithmeticOperand", line) + " " + op + " "
+            + number(right, "loxArithmeticOperand", line) + ")";
+        operand = {code, Type::NUMBER, stable, checked or not both};
+    };
+
+    auto comparison = [&](const string &op) {
+        auto code = "(" + number(left, "loxComparisonOperand", line) + " " + op + " "
+            + number(right, "loxComparisonOperand", line) + ")";
+        operand = {code, Type::BOOLEAN, stable, checked or not both};
+    };
+
+    auto equality = [&](const string &op) {
+        if (left.type == right.type and left.type != Type::VALUE) {
+            operand = {"(" + left.code + " " + op + " " + right.code + ")", Type::BOOLEAN, stable, checked};
+        } else {
+            auto code = "loxEqual(" + boxed(left) + ", " + boxed(right) + ")";
+            operand = {op == "==" ? code : "!" + code, Type::BOOLEAN, stable, checked};
+        }
+    };
+
+    switch (type) {
+        case TokenType::PLUS:
+            if (both) {
+                arithmetic("+");
+            } else {
+                // may concatenate, so the result has to stay reachable
+                auto index = slot(temporary());
+                emit(index + " = loxAdd(" + boxed(left) + ", " + boxed(right) + ", " + to_string(line) + ");");
+                operand = {index, Type::VALUE, true};
+            }
+            break;
+
+        case TokenType::MINUS:
+            arithmetic("-");
+            break;
+
+        case TokenType::STAR:
+            arithmetic("*");
+            break;
+
+        case TokenType::SLASH:
+            arithmetic("/");
+            break;
+
+        case TokenType::GREATER:
+            comparison(">");
+            break;
+
+        case TokenType::GREATER_EQUAL:
+            comparison(">=");
+            break;
+
+        case TokenType::LESS:
+            comparison("<");
+            break;
+
+        case TokenType::LESS_EQUAL:
+            comparison("<=");
+            break;
+
+        case TokenType::EQUAL_EQUAL:
+            equality("==");
+            break;
+
+        case TokenType::BANG_EQUAL:
+            equality("!=");
+            break;
+
+        default: ; // Unreachable
+    }
+}
+
+void Transpiler::visit(Grouping &expression) {
+    compile(*expression.content);
+}
+
+void Transpiler::visit(Literal &expression) {
+    const string &lexeme = expression.token->lexeme;
+
+    switch (expression.token->type) {
+        case TokenType::NUMBER:
+            operand = {numberLiteral(stod(lexeme)), Type::NUMBER, true};
+            break;
+
+        case TokenType::STRING: {
+            auto value = lexeme.substr(1, lexeme.length() - 2);
+            auto [entry, inserted] = stringIndices.try_emplace(value, strings.size());
+
+            if (inserted) {
+                strings.push_back(value);
+            }
+
+            operand = {"strings[" + to_string(entry->second) + "]", Type::VALUE, true};
+            break;
+        }
+
+        case TokenType::TRUE:
+            operand = {"1", Type::BOOLEAN, true};
+            break;
+
+        case TokenType::FALSE:
+            operand = {"0", Type::BOOLEAN, true};
+            break;
+
+        default:
+            operand = {"LOX_NIL", Type::VALUE, true};
+    }
+}
+
+void Transpiler::visit(Logical &expression) {
+    auto conjunction = expression.token->type == TokenType::AND;
+
+    auto left = compile(*expression.left);
+    auto index = slot(temporary());
+
+    // the right operand only runs if the left one doesn't decide
+    auto start = body.size();
+
+    ++indentation;
+    auto right = compile(*expression.right);
+    --indentation;
+
+    if (body.size() == start and left.type == Type::BOOLEAN and right.type == Type::BOOLEAN) {
+        auto code = "(" + left.code + (conjunction ? " && " : " || ") + right.code + ")";
+        operand = {code, Type::BOOLEAN, left.stable and right.stable, left.checked or right.checked};
+        return;
+    }
+
+    auto code = body.substr(start);
+    body.resize(start);
+
+    // a and b = b if a, else a; a or b = a if a, else b
+    emit(index + " = " + boxed(left) + ";");
+    emit(string{"if ("} + (conjunction ? "" : "!") + "loxIsTruthy(" + index + ")) {");
+    body += code;
+
+    ++indentation;
+    emit(index + " = " + boxed(right) + ";");
+    --indentation;
+
+    emit("}");
+
+    operand = {index, Type::VALUE, true};
+}
+
+void Transpiler::visit(Unary &expression) {
+    auto value = compile(*expression.operand);
+
+    if (expression.token->type == TokenType::MINUS) {
+        auto code = "(-" + number(value, "loxNegationOperand", expression.token->line) + ")";
+        operand = {code, Type::NUMBER, value.stable, value.checked or value.type != Type::NUMBER};
+    } else {
+        operand = {"!" + condition(value), Type::BOOLEAN, value.stable, value.checked};
+    }
+}
+
+void Transpiler::visit(Variable &expression) {
+    switch (expression.access) {
+        case Access::GLOBAL: {
+            auto index = slot(temporary());
+            emit(index + " = loxGetGlobal(" + global(*expression.name) + ", " + to_string(expression.name->line) + ");");
+            operand = {index, Type::VALUE, true};
+            break;
+        }
+
+        case Access::LOCAL: {
+            auto declaration = declarations[&expression];
+
+            if (numbers.count(declaration)) {
+                operand = {doubles[declaration], Type::NUMBER, false};
+            } else {
+                operand = {slot(expression.slot), Type::VALUE, false};
+            }
+            break;
+        }
+
+        case Access::CELL:
+            operand = {"loxGetCell(" + slot(expression.slot) + ")", Type::VALUE, false};
+            break;
+
+        case Access::UPVALUE:
+            operand = {"loxGetUpvalue(slots, " + to_string(expression.slot) + ")", Type::VALUE, false};
+            break;
+    }
+}
+
+void Transpiler::visit(Assign &expression) {
+    auto value = compile(*expression.value);
+    auto line = expression.name->line;
+
+    if (expression.access == Access::LOCAL) {
+        auto declaration = declarations[&expression];
+
+        if (numbers.count(declaration)) {
+            auto &name = doubles[declaration];
+            emit(name + " = " + number(value, "loxArithmeticOperand", line) + ";");
+            operand = {name, Type::NUMBER, false};
+        } else {
+            emit(slot(expression.slot) + " = " + boxed(value) + ";");
+            operand = {slot(expression.slot), Type::VALUE, false};
+        }
+
+        return;
+    }
+
+    // the value is the result of the assignment as well
+    if (not value.stable or value.checked) {
+        value = stabilize(value);
+    }
+
+    switch (expression.access) {
+        case Access::GLOBAL:
+            emit("loxSetGlobal(" + global(*expression.name) + ", " + boxed(value) + ", " + to_string(line) + ");");
+            break;
+
+        case Access::CELL:
+            emit("loxSetCell(" + slot(expression.slot) + ", " + boxed(value) + ");");
+            break;
+
+        case Access::UPVALUE:
+            emit("loxSetUpvalue(slots, " + to_string(expression.slot) + ", " + boxed(value) + ");");
+            break;
+
+        case Access::LOCAL: ; // handled above
+    }
+
+    operand = value;
+}
+
+void Transpiler::visit(Call &expression) {
+    auto base = compileCall(expression);
+
+    emit(slot(base) + " = loxCall(slots + " + to_string(base) + ", " + to_string(expression.arguments.size()) + ", "
+         + to_string(expression.paren->line) + ");");
+
+    operand = {slot(base), Type::VALUE, true};
+}
@@ -0,0 +1,153 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_TRANSPILER_H
+#define LOX_INTERPRETER_TRANSPILER_H
+
+#include "data/expression.h"
+#include "data/statement.h"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// writes a resolved program as a C program, given the size of its top-level frame
+void transpile(const std::vector<Statement_ptr> &statements, std::size_t slots, std::ostream &out);
+
+/*
+ * Translates the syntax tree, as annotated by the Resolver, into C that runs on the runtime library (see Runtime.h).
+ * Every Lox function becomes a C function whose frame has the interpreter's layout, and every expression becomes C
+ * code that stores the objects it produces in temporaries in the frame, above the locals, where the collector finds
+ * them.
+ *
+ * Locals that provably always hold Numbers are plain C doubles instead: those that aren't captured by a closure and
+ * are only ever assigned Numbers, i.e. number literals, results of -, *, / and unary minus, and sums of such Numbers.
+ * Arithmetic on them is plain double math, and an operand that may be anything is checked and unboxed inline. All other
+ * operations stay on boxed Values.
+ */
+class Transpiler : public ExpressionVisitor, StatementVisitor {
+
+public:
+    // what the C code of an expression evaluates to: a double, an int that is 0 or 1, or a LoxValue
+    enum class Type {
+        NUMBER, BOOLEAN, VALUE
+    };
+
+    void transpile(const std::vector<Statement_ptr> &statements, std::size_t slots, std::ostream &out);
+
+    // Member functions for Statement visitor interface
+    void visit(ExpressionStatement &statement) override;
+    void visit(Print &statement) override;
+    void visit(Block &statement) override;
+    void visit(Var &statement) override;
+    void visit(If &statement) override;
+    void visit(While &statement) override;
+    void visit(Function &statement) override;
+    void visit(Return &statement) override;
+
+    // Member functions for Expression visitor interface
+    void visit(Binary &expression) override;
+    void visit(Grouping &expression) override;
+    void visit(Literal &expression) override;
+    void visit(Logical &expression) override;
+    void visit(Unary &expression) override;
+    void visit(Variable &expression) override;
+    void visit(Assign &expression) override;
+    void visit(Call &expression) override;
+
+private:
+    // A compiled expression: C code without side effects other than a runtime error, which it can raise if `checked`.
+    // It is `stable` if other code running before it can't change its value, i.e. it only reads constants and
+    // temporaries rather than variables.
+    struct Operand {
+        std::string code;
+        Type type;
+        bool stable;
+        bool checked = false;
+    };
+
+    // the operand compiled from the last expression visited
+    Operand operand;
+
+    // the statements of the C function being generated, and their indentation
+    std::string body;
+    int indentation = 1;
+
+    // the size of the current function's frame, the temporaries in use above it, and the most in use at once
+    std::size_t frameSize = 0;
+    std::size_t depth = 0;
+    std::size_t maxDepth = 0;
+
+    // the C code of all functions, their prototypes and their LoxFunctions
+    std::string prototypes;
+    std::string descriptors;
+    std::string definitions;
+
+    // the globals and string literals the program refers to, by index into the C arrays holding them
+    std::vector<std::string> globals;
+    std::unordered_map<std::string, std::size_t> globalIndices;
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, std::size_t> stringIndices;
+
+    // makes C names unique
+    std::size_t names = 0;
+
+    // The declaration of the local every Variable and Assign of a local refers to, and every value assigned to a
+    // local, nullptr for nil. Locals in `numbers` are always assigned Numbers, and live in the C variable in `doubles`.
+    std::unordered_map<const Expression*, const Var*> declarations;
+    std::unordered_map<const Var*, std::vector<const Expression*>> values;
+    std::unordered_set<const Var*> numbers;
+    std::unordered_map<const Var*, std::string> doubles;
+
+    // the locals some Variable reads
+    std::unordered_set<const Var*> read;
+
+    // finds the locals that always hold Numbers
+    void analyze(const std::vector<Statement_ptr> &statements);
+
+    // the type of the C code an expression compiles to
+    Type typeOf(const Expression &expression) const;
+
+    void emit(const std::string &line);
+    std::string unique(const std::string &name);
+
+    // the C expression for a frame slot, and a slot for a new temporary
+    static std::string slot(std::size_t index);
+    std::size_t temporary();
+
+    void compile(Statement &statement);
+    Operand compile(Expression &expression);
+
+    // compiles the statements of a branch or loop body, which the caller encloses in braces
+    void compileBranch(Statement &statement);
+
+    // compiles a Lox function into a C function and returns the name of its LoxFunction
+    std::string compileFunction(Function &function);
+
+    // compiles the right operand of a binary operation after the left one, which the right one's code must not affect
+    Operand compileAfter(Operand &left, Expression &right);
+
+    // compiles the callee and arguments of a call into consecutive temporaries, returning the first
+    std::size_t compileCall(Call &call);
+
+    // emits code that evaluates an operand once, into a temporary or a C variable, and returns that
+    Operand stabilize(const Operand &operand);
+
+    // an operand as C code for a LoxValue, a double (checked with the given function) or a condition
+    static std::string boxed(const Operand &operand);
+    static std::string number(const Operand &operand, const char *check, int line);
+    static std::string condition(const Operand &operand);
+
+    // C literals
+    static std::string numberLiteral(double value);
+    static std::string stringLiteral(const std::string &value);
+
+    std::string global(const Token &name);
+};
+
+
+#endif //LOX_INTERPRETER_TRANSPILER_H
@@ -0,0 +1,33 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "Chunk.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+const char* nameOf(RegisterOp op) {
+    static const char *names[] = {
+        "MOVE", "LOAD_CONSTANT", "LOAD_NIL", "LOAD_BOOLEAN", "GET_CELL", "SET_CELL", "NEW_CELL", "GET_UPVALUE",
+        "SET_UPVALUE", "GET_GLOBAL", "SET_GLOBAL", "DEFINE_GLOBAL", "EQUAL", "NOT_EQUAL", "GREATER", "GREATER_EQUAL",
+        "LESS", "LESS_EQUAL", "ADD", "SUBTRACT", "MULTIPLY", "DIVIDE", "NOT", "NEGATE", "PRINT", "JUMP",
+        "JUMP_IF_FALSE", "JUMP_IF_TRUE", "ADD_CONSTANT", "SUBTRACT_CONSTANT", "JUMP_UNLESS_LESS",
+        "JUMP_UNLESS_LESS_CONSTANT", "JUMP_UNLESS_EQUAL_CONSTANT", "CALL", "TAIL_CALL", "CLOSURE", "RETURN"
+    };
+
+    static_assert(size(names) == REGISTER_OPS, "one name per instruction, in order");
+
+    return names[static_cast<size_t>(op)];
+}
+
+const Token& Chunk::tokenAt(size_t offset) const {
+    // instructions are emitted in order, so the table is sorted by offset
+    auto token = lower_bound(tokens.begin(), tokens.end(), offset, [](const auto &entry, size_t offset) {
+        return entry.first < offset;
+    });
+
+    return *token->second;
+}
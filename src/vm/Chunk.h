@@ -0,0 +1,180 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_CHUNK_H
+#define LOX_INTERPRETER_CHUNK_H
+
+#include "data/token.h"
+#include "interpreter/Value.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Forward declarations
+struct Function;
+struct CallSite;
+class NativeCode;
+
+
+/*
+ * Instructions of the bytecode VM. Operands follow the opcode: slots, constants, globals, functions and jump offsets
+ * are 16 bit (little endian), argument counts 8 bit. The comments give the operands and the effect on the stack.
+ */
+enum class OpCode : std::uint8_t {
+    // constant: push constants[constant]
+    CONSTANT,
+
+    // push nil, true or false
+    NIL, TRUE, FALSE,
+
+    // discard the top of the stack
+    POP,
+
+    // slot: push the local in the current frame / store the top of the stack into it, leaving it on the stack
+    GET_LOCAL, SET_LOCAL,
+
+    // slot: pop the top of the stack into the local / into a new Cell stored in the local
+    DEFINE_LOCAL, DEFINE_CELL,
+
+    // slot: push the value of the Cell in the local / store the top of the stack into it
+    GET_CELL, SET_CELL,
+
+    // index: push the value of the current function's upvalue / store the top of the stack into it
+    GET_UPVALUE, SET_UPVALUE,
+
+    // global: push the global / store the top of the stack into it / pop the top of the stack into it
+    GET_GLOBAL, SET_GLOBAL, DEFINE_GLOBAL,
+
+    // replace the top two values with the result of the binary operator
+    EQUAL, NOT_EQUAL, GREATER, GREATER_EQUAL, LESS, LESS_EQUAL, ADD, SUBTRACT, MULTIPLY, DIVIDE,
+
+    // replace the top of the stack with the result of the unary operator
+    NOT, NEGATE,
+
+    // pop the top of the stack and print it
+    PRINT,
+
+    // offset: jump forward / jump forward if the top of the stack is falsey, leaving it on the stack / jump backward
+    JUMP, JUMP_IF_FALSE, LOOP,
+
+    // count: call the value below the top `count` values with them as arguments, replacing all with the result
+    CALL,
+
+    // count: like CALL, but return the result from the current function, reusing its frame for the callee
+    TAIL_CALL,
+
+    // function: push a closure of functions[function] over the current frame and function
+    CLOSURE,
+
+    // pop the top of the stack and return it from the current function
+    RETURN
+};
+
+
+/*
+ * Instructions of the register VM, which operate on the registers of the current frame: its locals, at the slots the
+ * Resolver assigned, followed by temporaries. Every instruction has three 16 bit operands, `a` usually being the
+ * destination. R[x] denotes register x.
+ */
+enum class RegisterOp : std::uint8_t {
+    // R[a] = R[b] / constants[b] / nil / b != 0
+    MOVE, LOAD_CONSTANT, LOAD_NIL, LOAD_BOOLEAN,
+
+    // R[a] = the value of the Cell in R[b] / store R[b] into the Cell in R[a] / R[a] = a new Cell holding R[b]
+    GET_CELL, SET_CELL, NEW_CELL,
+
+    // R[a] = the value of upvalue b / store R[b] into upvalue a
+    GET_UPVALUE, SET_UPVALUE,
+
+    // R[a] = global b / store R[b] into global a / define global a as R[b]
+    GET_GLOBAL, SET_GLOBAL, DEFINE_GLOBAL,
+
+    // R[a] = R[b] <operator> R[c]
+    EQUAL, NOT_EQUAL, GREATER, GREATER_EQUAL, LESS, LESS_EQUAL, ADD, SUBTRACT, MULTIPLY, DIVIDE,
+
+    // R[a] = <operator> R[b]
+    NOT, NEGATE,
+
+    // print R[a]
+    PRINT,
+
+    // continue at instruction b / if R[a] is falsey / truthy
+    JUMP, JUMP_IF_FALSE, JUMP_IF_TRUE,
+
+    // Superinstructions, fused from common sequences by the peephole optimizer:
+
+    // R[a] = R[b] + constants[c] / R[b] - constants[c]
+    ADD_CONSTANT, SUBTRACT_CONSTANT,
+
+    // continue at instruction c unless R[a] < R[b] / R[a] < constants[b] / R[a] == constants[b]
+    JUMP_UNLESS_LESS, JUMP_UNLESS_LESS_CONSTANT, JUMP_UNLESS_EQUAL_CONSTANT,
+
+    // call R[a] with the b arguments R[a + 1] ... R[a + b], storing the result into R[a], using the inline cache
+    // callSites[c]
+    CALL,
+
+    // like CALL, but return the result from the current function, reusing its frame for the callee
+    TAIL_CALL,
+
+    // R[a] = a closure of functions[b] over the current frame and function
+    CLOSURE,
+
+    // return R[a] from the current function
+    RETURN
+};
+
+constexpr std::size_t REGISTER_OPS = static_cast<std::size_t>(RegisterOp::RETURN) + 1;
+
+// the name of an instruction, e.g. for profiles
+const char* nameOf(RegisterOp op);
+
+struct Instruction {
+    RegisterOp op;
+    std::uint16_t a;
+    std::uint16_t b;
+    std::uint16_t c;
+};
+
+
+/*
+ * Bytecode compiled from a function (or the top level of a program) by the Compiler or the RegisterCompiler, together
+ * with the constants and function declarations it refers to.
+ */
+struct Chunk {
+    // for the stack VM
+    std::vector<std::uint8_t> code;
+
+    // for the register VM
+    std::vector<Instruction> instructions;
+
+    // numbers and interned Strings; Strings are pinned by the compilers, since chunks aren't traced
+    std::vector<Value> constants;
+
+    std::vector<std::shared_ptr<Function>> functions;
+
+    // the inline caches of the register VM's calls, shared with the Call nodes they were compiled from
+    std::vector<std::shared_ptr<CallSite>> callSites;
+
+    // the number of stack slots a call needs: its frame plus the most temporaries (or registers) in use at once
+    std::size_t stackSize = 0;
+
+    // the token of every instruction that may raise a runtime error, by the offset right behind the instruction (in
+    // bytes for the stack VM, in instructions for the register VM)
+    std::vector<std::pair<std::size_t, Token_ptr>> tokens;
+
+    // Kept by the register VM for the baseline JIT: how often the chunk was entered or jumped backwards in before it got
+    // compiled, its machine code, if any, and how often that left to the interpreter on a failed type guard
+    mutable std::uint32_t hotness = 0;
+    mutable std::uint32_t deopts = 0;
+    mutable std::shared_ptr<NativeCode> native;
+
+    // the token of the instruction that ends at the given offset
+    const Token& tokenAt(std::size_t offset) const;
+};
+
+
+#endif //LOX_INTERPRETER_CHUNK_H
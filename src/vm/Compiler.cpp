@@ -0,0 +1,431 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "Compiler.h"
+
+#include "interpreter/LoxObject.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+shared_ptr<Chunk> compile(const vector<Statement_ptr> &statements, size_t slots, Globals &globals) {
+    Compiler compiler {globals};
+    return compiler.compile(statements, slots);
+}
+
+Compiler::Compiler(Globals &globals) : globals{globals} {}
+
+shared_ptr<Chunk> Compiler::compile(const vector<Statement_ptr> &statements, size_t slots) {
+    return compileBody(statements, slots);
+}
+
+shared_ptr<Chunk> Compiler::compileBody(const vector<Statement_ptr> &statements, size_t slots) {
+    auto compiled = make_shared<Chunk>();
+
+    // retain the enclosing function's state
+    auto enclosing = chunk;
+    auto enclosingDepth = depth;
+    auto enclosingMaxDepth = maxDepth;
+
+    chunk = compiled.get();
+    depth = 0;
+    maxDepth = 0;
+
+    for (const auto &statement : statements) {
+        compile(*statement);
+    }
+
+    // falling off the end returns nil
+    emit(OpCode::NIL, +1);
+    emit(OpCode::RETURN, -1);
+
+    compiled->stackSize = slots + maxDepth;
+
+    chunk = enclosing;
+    depth = enclosingDepth;
+    maxDepth = enclosingMaxDepth;
+
+    return compiled;
+}
+
+void Compiler::compile(Statement &statement) {
+    statement.accept(*this);
+}
+
+void Compiler::compile(Expression &expression) {
+    expression.accept(*this);
+}
+
+
+// Emitting instructions
+
+void Compiler::emit(OpCode op, int effect) {
+    emitByte(static_cast<uint8_t>(op));
+
+    depth += effect;
+    maxDepth = max(maxDepth, depth);
+}
+
+void Compiler::emit(OpCode op, int effect, uint16_t operand) {
+    emit(op, effect);
+    emitShort(operand);
+}
+
+void Compiler::emitByte(uint8_t byte) {
+    chunk->code.push_back(byte);
+}
+
+void Compiler::emitShort(uint16_t value) {
+    emitByte(static_cast<uint8_t>(value & 0xff));
+    emitByte(static_cast<uint8_t>(value >> 8));
+}
+
+void Compiler::mark(const Token_ptr &token) {
+    chunk->tokens.emplace_back(chunk->code.size(), token);
+    line = token->line;
+}
+
+void Compiler::emitConstant(Value value) {
+    auto &constants = chunk->constants;
+
+    // identical bits, so that e.g. 0 and -0 stay distinct
+    auto existing = find_if(constants.begin(), constants.end(), [&](const Value &constant) {
+        return memcmp(&constant, &value, sizeof(Value)) == 0;
+    });
+
+    auto index = existing - constants.begin();
+
+    if (existing == constants.end()) {
+        constants.push_back(value);
+    }
+
+    emit(OpCode::CONSTANT, +1, checked(index, "constants"));
+}
+
+uint16_t Compiler::global(const Token &name) {
+    line = name.line;
+    return checked(globals.bind(name.lexeme), "global variables");
+}
+
+size_t Compiler::emitJump(OpCode op) {
+    emit(op, 0, 0xffff);
+    return chunk->code.size() - 2;
+}
+
+void Compiler::patchJump(size_t offset) {
+    // relative to the end of the jump instruction
+    auto distance = checked(chunk->code.size() - offset - 2, "bytes to jump over");
+
+    chunk->code[offset] = static_cast<uint8_t>(distance & 0xff);
+    chunk->code[offset + 1] = static_cast<uint8_t>(distance >> 8);
+}
+
+void Compiler::emitLoop(size_t start) {
+    auto distance = checked(chunk->code.size() + 3 - start, "bytes in loop body");
+    emit(OpCode::LOOP, 0, distance);
+}
+
+void Compiler::emitDefine(Access access, int slot, const Token &name) {
+    switch (access) {
+        case Access::GLOBAL:
+            emit(OpCode::DEFINE_GLOBAL, -1, global(name));
+            break;
+
+        case Access::LOCAL:
+            emit(OpCode::DEFINE_LOCAL, -1, checked(slot, "local variables"));
+            break;
+
+        case Access::CELL:
+            emit(OpCode::DEFINE_CELL, -1, checked(slot, "local variables"));
+            break;
+
+        case Access::UPVALUE: ; // Unreachable, declarations are never upvalues
+    }
+}
+
+uint16_t Compiler::checked(size_t value, const char *what) {
+    if (value > numeric_limits<uint16_t>::max()) {
+        throw CompileError(line, string{"Too many "} + what + " in one function.");
+    }
+
+    return static_cast<uint16_t>(value);
+}
+
+
+// Statement Visitor
+
+void Compiler::visit(ExpressionStatement &statement) {
+    compile(*statement.expression);
+    emit(OpCode::POP, -1);
+}
+
+void Compiler::visit(Print &statement) {
+    compile(*statement.expression);
+    emit(OpCode::PRINT, -1);
+}
+
+void Compiler::visit(Block &statement) {
+    // the block's variables have their own slots in the current frame
+    for (const auto &s : statement.statements) {
+        compile(*s);
+    }
+}
+
+void Compiler::visit(Var &statement) {
+    if (statement.initializer) {
+        compile(*statement.initializer);
+    } else {
+        emit(OpCode::NIL, +1);
+    }
+
+    emitDefine(statement.access, statement.slot, *statement.name);
+}
+
+void Compiler::visit(If &statement) {
+    compile(*statement.condition);
+
+    auto elseJump = emitJump(OpCode::JUMP_IF_FALSE);
+    emit(OpCode::POP, -1);
+    compile(*statement.thenBranch);
+
+    auto endJump = emitJump(OpCode::JUMP);
+    patchJump(elseJump);
+
+    // the condition is still on the stack when jumping to the else branch
+    depth += 1;
+    emit(OpCode::POP, -1);
+
+    if (statement.elseBranch) {
+        compile(*statement.elseBranch);
+    }
+
+    patchJump(endJump);
+}
+
+void Compiler::visit(While &statement) {
+    auto start = chunk->code.size();
+    compile(*statement.condition);
+
+    auto exitJump = emitJump(OpCode::JUMP_IF_FALSE);
+    emit(OpCode::POP, -1);
+    compile(*statement.body);
+    emitLoop(start);
+
+    patchJump(exitJump);
+
+    depth += 1;
+    emit(OpCode::POP, -1);
+}
+
+void Compiler::visit(Function &statement) {
+    auto &name = *statement.name;
+    line = name.line;
+
+    statement.chunk = compileBody(statement.body, statement.frameSize);
+
+    auto index = checked(chunk->functions.size(), "functions");
+    chunk->functions.push_back(statement.shared_from_this());
+
+    // a function that refers to itself captures its own variable, so the Cell has to exist before the closure
+    if (statement.access == Access::CELL) {
+        auto slot = checked(statement.slot, "local variables");
+
+        emit(OpCode::NIL, +1);
+        emit(OpCode::DEFINE_CELL, -1, slot);
+        emit(OpCode::CLOSURE, +1, index);
+        emit(OpCode::SET_CELL, 0, slot);
+        emit(OpCode::POP, -1);
+    } else {
+        emit(OpCode::CLOSURE, +1, index);
+        emitDefine(statement.access, statement.slot, name);
+    }
+}
+
+void Compiler::visit(Return &statement) {
+    if (statement.tailCall) {
+        auto &call = *statement.tailCall;
+        auto arguments = static_cast<int>(call.arguments.size());
+
+        compile(*call.callee);
+
+        for (const auto &argument : call.arguments) {
+            compile(*argument);
+        }
+
+        emit(OpCode::TAIL_CALL, -arguments - 1);
+        emitByte(static_cast<uint8_t>(arguments));
+        mark(call.paren);
+        return;
+    }
+
+    if (statement.value) {
+        compile(*statement.value);
+    } else {
+        emit(OpCode::NIL, +1);
+    }
+
+    emit(OpCode::RETURN, -1);
+}
+
+
+// Expression Visitor
+
+void Compiler::visit(Binary &expression) {
+    compile(*expression.left);
+    compile(*expression.right);
+
+    switch (expression.token->type) {
+        case TokenType::MINUS: emit(OpCode::SUBTRACT, -1); break;
+        case TokenType::SLASH: emit(OpCode::DIVIDE, -1); break;
+        case TokenType::STAR: emit(OpCode::MULTIPLY, -1); break;
+        case TokenType::PLUS: emit(OpCode::ADD, -1); break;
+        case TokenType::GREATER: emit(OpCode::GREATER, -1); break;
+        case TokenType::GREATER_EQUAL: emit(OpCode::GREATER_EQUAL, -1); break;
+        case TokenType::LESS: emit(OpCode::LESS, -1); break;
+        case TokenType::LESS_EQUAL: emit(OpCode::LESS_EQUAL, -1); break;
+        case TokenType::BANG_EQUAL: emit(OpCode::NOT_EQUAL, -1); break;
+        case TokenType::EQUAL_EQUAL: emit(OpCode::EQUAL, -1); break;
+        default: ; // Unreachable
+    }
+
+    mark(expression.token);
+}
+
+void Compiler::visit(Grouping &expression) {
+    compile(*expression.content);
+}
+
+void Compiler::visit(Literal &expression) {
+    const auto &token = *expression.token;
+    const string &lexeme = token.lexeme;
+
+    line = token.line;
+
+    switch (token.type) {
+        case TokenType::NIL: emit(OpCode::NIL, +1); break;
+        case TokenType::TRUE: emit(OpCode::TRUE, +1); break;
+        case TokenType::FALSE: emit(OpCode::FALSE, +1); break;
+
+        case TokenType::NUMBER: {
+            emitConstant(Value::number(stod(lexeme)));
+            break;
+        }
+
+        case TokenType::STRING: {
+            emitConstant(String::NewSymbol(lexeme.substr(1, lexeme.length() - 2)));
+            break;
+        }
+
+        default: ;
+    }
+}
+
+void Compiler::visit(Logical &expression) {
+    const auto &token = *expression.token;
+
+    compile(*expression.left);
+
+    if (token.type == TokenType::AND) {
+        // a and b = b if a, else a
+        auto endJump = emitJump(OpCode::JUMP_IF_FALSE);
+        emit(OpCode::POP, -1);
+        compile(*expression.right);
+        patchJump(endJump);
+    } else {
+        // a or b = a if a, else b
+        auto elseJump = emitJump(OpCode::JUMP_IF_FALSE);
+        auto endJump = emitJump(OpCode::JUMP);
+        patchJump(elseJump);
+        emit(OpCode::POP, -1);
+        compile(*expression.right);
+        patchJump(endJump);
+    }
+}
+
+void Compiler::visit(Unary &expression) {
+    compile(*expression.operand);
+
+    if (expression.token->type == TokenType::MINUS) {
+        emit(OpCode::NEGATE, 0);
+        mark(expression.token);
+    } else {
+        emit(OpCode::NOT, 0);
+    }
+}
+
+void Compiler::visit(Variable &expression) {
+    auto &name = *expression.name;
+    line = name.line;
+
+    switch (expression.access) {
+        case Access::GLOBAL:
+            emit(OpCode::GET_GLOBAL, +1, global(name));
+            mark(expression.name);
+            break;
+
+        case Access::LOCAL:
+            emit(OpCode::GET_LOCAL, +1, checked(expression.slot, "local variables"));
+            break;
+
+        case Access::CELL:
+            emit(OpCode::GET_CELL, +1, checked(expression.slot, "local variables"));
+            break;
+
+        case Access::UPVALUE:
+            emit(OpCode::GET_UPVALUE, +1, checked(expression.slot, "upvalues"));
+            break;
+    }
+}
+
+void Compiler::visit(Assign &expression) {
+    auto &name = *expression.name;
+
+    compile(*expression.value);
+    line = name.line;
+
+    switch (expression.access) {
+        case Access::GLOBAL:
+            emit(OpCode::SET_GLOBAL, 0, global(name));
+            mark(expression.name);
+            break;
+
+        case Access::LOCAL:
+            emit(OpCode::SET_LOCAL, 0, checked(expression.slot, "local variables"));
+            break;
+
+        case Access::CELL:
+            emit(OpCode::SET_CELL, 0, checked(expression.slot, "local variables"));
+            break;
+
+        case Access::UPVALUE:
+            emit(OpCode::SET_UPVALUE, 0, checked(expression.slot, "upvalues"));
+            break;
+    }
+}
+
+void Compiler::visit(Call &expression) {
+    auto arguments = static_cast<int>(expression.arguments.size());
+
+    compile(*expression.callee);
+
+    for (const auto &argument : expression.arguments) {
+        compile(*argument);
+    }
+
+    emit(OpCode::CALL, -arguments);
+    emitByte(static_cast<uint8_t>(arguments));
+    mark(expression.paren);
+}
+
+
+// CompileError
+
+CompileError::CompileError(int line, string message) : line{line}, message{move(message)} {}
+
+string CompileError::what() const noexcept {
+    return report(line, "", message);
+}
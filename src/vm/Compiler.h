@@ -0,0 +1,106 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_COMPILER_H
+#define LOX_INTERPRETER_COMPILER_H
+
+#include "Chunk.h"
+#include "data/expression.h"
+#include "data/statement.h"
+#include "interpreter/Globals.h"
+#include "error.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// compiles a resolved program into a chunk for its top-level code, given the size of the top-level frame
+std::shared_ptr<Chunk> compile(const std::vector<Statement_ptr> &statements, std::size_t slots, Globals &globals);
+
+/*
+ * Translates the syntax tree, as annotated by the Resolver, into bytecode for the VM. Every function declaration is
+ * compiled into its own Chunk, stored in the declaration. Locals keep the slots the Resolver assigned to them, so a
+ * call frame on the VM stack has the same layout as one of the tree-walking Interpreter; globals are bound to their
+ * index in the Globals at compile time.
+ */
+class Compiler : public ExpressionVisitor, StatementVisitor {
+
+public:
+    explicit Compiler(Globals &globals);
+
+    std::shared_ptr<Chunk> compile(const std::vector<Statement_ptr> &statements, std::size_t slots);
+
+    // Member functions for Statement visitor interface
+    void visit(ExpressionStatement &statement) override;
+    void visit(Print &statement) override;
+    void visit(Block &statement) override;
+    void visit(Var &statement) override;
+    void visit(If &statement) override;
+    void visit(While &statement) override;
+    void visit(Function &statement) override;
+    void visit(Return &statement) override;
+
+    // Member functions for Expression visitor interface
+    void visit(Binary &expression) override;
+    void visit(Grouping &expression) override;
+    void visit(Literal &expression) override;
+    void visit(Logical &expression) override;
+    void visit(Unary &expression) override;
+    void visit(Variable &expression) override;
+    void visit(Assign &expression) override;
+    void visit(Call &expression) override;
+
+private:
+    Globals &globals;
+
+    // the chunk being compiled, the number of temporaries on the stack at the current instruction and the most so far
+    Chunk *chunk = nullptr;
+    int depth = 0;
+    int maxDepth = 0;
+
+    // the line of the most recent token compiled, to report errors at
+    int line = 0;
+
+    void compile(Statement &statement);
+    void compile(Expression &expression);
+
+    // compiles a function or the top level, with the given frame size, into a new chunk
+    std::shared_ptr<Chunk> compileBody(const std::vector<Statement_ptr> &statements, std::size_t slots);
+
+    // emits an instruction and accounts for its effect on the number of temporaries
+    void emit(OpCode op, int effect);
+    void emit(OpCode op, int effect, std::uint16_t operand);
+    void emitByte(std::uint8_t byte);
+    void emitShort(std::uint16_t value);
+
+    // associates the instruction just emitted with a token to report its runtime errors at
+    void mark(const Token_ptr &token);
+
+    void emitConstant(Value value);
+    std::uint16_t global(const Token &name);
+
+    // emits a forward jump with an offset to be patched once the target is known, returning where the offset is
+    std::size_t emitJump(OpCode op);
+    void patchJump(std::size_t offset);
+    void emitLoop(std::size_t start);
+
+    // emits the instructions that store the top of the stack into a variable that is being declared
+    void emitDefine(Access access, int slot, const Token &name);
+
+    // operands are 16 bit
+    std::uint16_t checked(std::size_t value, const char *what);
+};
+
+struct CompileError : public LoxError {
+    int line;
+    std::string message;
+
+    CompileError(int line, std::string message);
+    std::string what() const noexcept override;
+};
+
+
+#endif //LOX_INTERPRETER_COMPILER_H
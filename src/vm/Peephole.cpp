@@ -0,0 +1,273 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "Peephole.h"
+
+#include "data/statement.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using Op = RegisterOp;
+
+// a set of registers
+class Registers {
+
+public:
+    explicit Registers(size_t count = 0) : words((count + 63) / 64) {}
+
+    bool contains(size_t reg) const {
+        return words[reg / 64] >> (reg % 64) & 1;
+    }
+
+    void insert(size_t reg) {
+        words[reg / 64] |= uint64_t{1} << (reg % 64);
+    }
+
+    void erase(size_t reg) {
+        words[reg / 64] &= ~(uint64_t{1} << (reg % 64));
+    }
+
+    // adds the registers of another set, returning whether any were new
+    bool merge(const Registers &other) {
+        uint64_t changed = 0;
+
+        for (size_t i = 0; i < words.size(); ++i) {
+            changed |= other.words[i] & ~words[i];
+            words[i] |= other.words[i];
+        }
+
+        return changed != 0;
+    }
+
+private:
+    vector<uint64_t> words;
+};
+
+bool isJump(Op op) {
+    return op == Op::JUMP or op == Op::JUMP_IF_FALSE or op == Op::JUMP_IF_TRUE;
+}
+
+bool isFusedJump(Op op) {
+    return op == Op::JUMP_UNLESS_LESS or op == Op::JUMP_UNLESS_LESS_CONSTANT or op == Op::JUMP_UNLESS_EQUAL_CONSTANT;
+}
+
+// whether an instruction writes R[a]
+bool defines(const Instruction &instruction) {
+    switch (instruction.op) {
+        case Op::SET_CELL: case Op::SET_UPVALUE: case Op::SET_GLOBAL: case Op::DEFINE_GLOBAL: case Op::PRINT:
+        case Op::JUMP: case Op::JUMP_IF_FALSE: case Op::JUMP_IF_TRUE: case Op::JUMP_UNLESS_LESS:
+        case Op::JUMP_UNLESS_LESS_CONSTANT: case Op::JUMP_UNLESS_EQUAL_CONSTANT: case Op::TAIL_CALL: case Op::RETURN:
+            return false;
+
+        default:
+            return true;
+    }
+}
+
+// calls `use` with every register an instruction reads
+template<typename F>
+void forEachUse(const Chunk &chunk, const Instruction &instruction, F use) {
+    switch (instruction.op) {
+        case Op::LOAD_CONSTANT: case Op::LOAD_NIL: case Op::LOAD_BOOLEAN: case Op::GET_UPVALUE: case Op::GET_GLOBAL:
+        case Op::JUMP:
+            break;
+
+        case Op::MOVE: case Op::GET_CELL: case Op::NEW_CELL: case Op::SET_UPVALUE: case Op::SET_GLOBAL:
+        case Op::DEFINE_GLOBAL: case Op::NOT: case Op::NEGATE: case Op::ADD_CONSTANT: case Op::SUBTRACT_CONSTANT:
+            use(instruction.b);
+            break;
+
+        case Op::PRINT: case Op::JUMP_IF_FALSE: case Op::JUMP_IF_TRUE: case Op::JUMP_UNLESS_LESS_CONSTANT:
+        case Op::JUMP_UNLESS_EQUAL_CONSTANT: case Op::RETURN:
+            use(instruction.a);
+            break;
+
+        case Op::SET_CELL: case Op::JUMP_UNLESS_LESS:
+            use(instruction.a);
+            use(instruction.b);
+            break;
+
+        case Op::EQUAL: case Op::NOT_EQUAL: case Op::GREATER: case Op::GREATER_EQUAL: case Op::LESS:
+        case Op::LESS_EQUAL: case Op::ADD: case Op::SUBTRACT: case Op::MULTIPLY: case Op::DIVIDE:
+            use(instruction.b);
+            use(instruction.c);
+            break;
+
+        case Op::CALL: case Op::TAIL_CALL:
+            for (size_t reg = instruction.a; reg <= size_t(instruction.a) + instruction.b; ++reg) {
+                use(reg);
+            }
+            break;
+
+        case Op::CLOSURE:
+            for (const auto &upvalue : chunk.functions[instruction.b]->upvalues) {
+                if (upvalue.local) {
+                    use(upvalue.index);
+                }
+            }
+            break;
+    }
+}
+
+// the instruction a jump continues at
+uint16_t& target(Instruction &instruction) {
+    return isFusedJump(instruction.op) ? instruction.c : instruction.b;
+}
+
+// calls `next` with the index of every instruction that may run right after the one at index
+template<typename F>
+void forEachSuccessor(const Chunk &chunk, size_t index, F next) {
+    auto instruction = chunk.instructions[index];
+
+    if (instruction.op == Op::TAIL_CALL or instruction.op == Op::RETURN) {
+        return;
+    }
+
+    if (isJump(instruction.op) or isFusedJump(instruction.op)) {
+        next(target(instruction));
+
+        if (instruction.op == Op::JUMP) {
+            return;
+        }
+    }
+
+    next(index + 1);
+}
+
+// the registers live on entry to every instruction, i.e. read by it or later, before being written
+vector<Registers> liveness(const Chunk &chunk) {
+    auto count = chunk.instructions.size();
+    vector<Registers> live(count, Registers{chunk.stackSize});
+
+    // iterate backward until nothing changes; the loops of a program take few rounds
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        for (auto index = count; index-- > 0;) {
+            auto &instruction = chunk.instructions[index];
+
+            Registers in {chunk.stackSize};
+            forEachSuccessor(chunk, index, [&](size_t next) {
+                in.merge(live[next]);
+            });
+
+            if (defines(instruction)) {
+                in.erase(instruction.a);
+            }
+
+            forEachUse(chunk, instruction, [&](size_t reg) {
+                in.insert(reg);
+            });
+
+            changed = live[index].merge(in) or changed;
+        }
+    }
+
+    return live;
+}
+
+}
+
+void fuseInstructions(Chunk &chunk) {
+    auto &code = chunk.instructions;
+    auto count = code.size();
+
+    auto live = liveness(chunk);
+
+    vector<bool> targeted(count + 1);
+    for (auto &instruction : code) {
+        if (isJump(instruction.op)) {
+            targeted[target(instruction)] = true;
+        }
+    }
+
+    // whether a register is dead once the instruction at index has run
+    auto deadAfter = [&](size_t index, size_t reg) {
+        bool dead = true;
+
+        forEachSuccessor(chunk, index, [&](size_t next) {
+            dead = dead and not live[next].contains(reg);
+        });
+
+        return dead;
+    };
+
+    // a fused instruction replaces the last instruction of its sequence, the others are removed
+    vector<bool> removed(count);
+
+    for (size_t index = 0; index + 1 < count; ++index) {
+        auto &first = code[index];
+        auto &second = code[index + 1];
+
+        if (targeted[index + 1]) {
+            continue;
+        }
+
+        if (first.op == Op::LOAD_CONSTANT and (second.op == Op::ADD or second.op == Op::SUBTRACT)
+            and second.c == first.a and second.b != first.a and (second.a == first.a or deadAfter(index + 1, first.a))) {
+
+            auto op = second.op == Op::ADD ? Op::ADD_CONSTANT : Op::SUBTRACT_CONSTANT;
+            second = {op, second.a, second.b, first.b};
+            removed[index] = true;
+            ++index;
+            continue;
+        }
+
+        if (first.op == Op::LESS and second.op == Op::JUMP_IF_FALSE and second.a == first.a
+            and deadAfter(index + 1, first.a)) {
+
+            second = {Op::JUMP_UNLESS_LESS, first.b, first.c, second.b};
+            removed[index] = true;
+            ++index;
+            continue;
+        }
+
+        if (index + 2 >= count or targeted[index + 2]) {
+            continue;
+        }
+
+        auto &third = code[index + 2];
+
+        if (first.op == Op::LOAD_CONSTANT and (second.op == Op::LESS or second.op == Op::EQUAL)
+            and second.c == first.a and second.b != first.a and (second.a == first.a or deadAfter(index + 1, first.a))
+            and third.op == Op::JUMP_IF_FALSE and third.a == second.a and deadAfter(index + 2, second.a)) {
+
+            auto op = second.op == Op::LESS ? Op::JUMP_UNLESS_LESS_CONSTANT : Op::JUMP_UNLESS_EQUAL_CONSTANT;
+            third = {op, second.b, first.b, third.b};
+            removed[index] = removed[index + 1] = true;
+            index += 2;
+        }
+    }
+
+    // where every instruction ends up; a removed one maps to the instruction that follows it
+    vector<size_t> moved(count + 1);
+    size_t kept = 0;
+
+    for (size_t index = 0; index < count; ++index) {
+        moved[index] = kept;
+
+        if (not removed[index]) {
+            code[kept++] = code[index];
+        }
+    }
+
+    moved[count] = kept;
+    code.resize(kept);
+
+    for (auto &instruction : code) {
+        if (isJump(instruction.op) or isFusedJump(instruction.op)) {
+            target(instruction) = moved[target(instruction)];
+        }
+    }
+
+    // at most one instruction of a fused sequence has a token, which moves to the fused instruction
+    for (auto &[offset, token] : chunk.tokens) {
+        offset = moved[offset - 1] + 1;
+    }
+}
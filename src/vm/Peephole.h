@@ -0,0 +1,25 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_PEEPHOLE_H
+#define LOX_INTERPRETER_PEEPHOLE_H
+
+#include "Chunk.h"
+
+/*
+ * Fuses the most frequent sequences of register VM instructions into superinstructions, so the VM dispatches once
+ * where it would dispatch two or three times:
+ *
+ *     LOAD_CONSTANT t k; ADD a b t                  =>  ADD_CONSTANT a b k        (also SUBTRACT)
+ *     LESS t a b; JUMP_IF_FALSE t l                 =>  JUMP_UNLESS_LESS a b l
+ *     LOAD_CONSTANT t k; LESS u a t; JUMP_IF_FALSE  =>  JUMP_UNLESS_LESS_CONSTANT a k l   (also EQUAL)
+ *
+ * A sequence is only fused if no jump lands in the middle of it and the registers the fused instruction no longer
+ * writes are dead afterwards, which a liveness analysis over the chunk's control flow decides. Jump targets and the
+ * offsets of tokens are adjusted for the instructions removed.
+ */
+void fuseInstructions(Chunk &chunk);
+
+
+#endif //LOX_INTERPRETER_PEEPHOLE_H
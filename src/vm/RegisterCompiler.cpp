@@ -0,0 +1,587 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "RegisterCompiler.h"
+
+#include "Compiler.h"
+#include "Peephole.h"
+#include "interpreter/LoxObject.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+namespace {
+
+// whether an expression assigns to the local in the given slot, which would change a register read before it
+class AssignsLocal : public ExpressionVisitor {
+
+public:
+    explicit AssignsLocal(int slot) : slot{slot} {}
+
+    bool found = false;
+
+    void visit(Binary &expression) override {
+        expression.left->accept(*this);
+        expression.right->accept(*this);
+    }
+
+    void visit(Grouping &expression) override {
+        expression.content->accept(*this);
+    }
+
+    void visit(Literal &expression) override {}
+
+    void visit(Logical &expression) override {
+        expression.left->accept(*this);
+        expression.right->accept(*this);
+    }
+
+    void visit(Unary &expression) override {
+        expression.operand->accept(*this);
+    }
+
+    void visit(Variable &expression) override {}
+
+    void visit(Assign &expression) override {
+        found = found or (expression.access == Access::LOCAL and expression.slot == slot);
+        expression.value->accept(*this);
+    }
+
+    void visit(Call &expression) override {
+        expression.callee->accept(*this);
+
+        for (const auto &argument : expression.arguments) {
+            argument->accept(*this);
+        }
+    }
+
+private:
+    int slot;
+};
+
+bool assignsLocal(Expression &expression, int slot) {
+    AssignsLocal visitor {slot};
+    expression.accept(visitor);
+    return visitor.found;
+}
+
+}
+
+shared_ptr<Chunk> compileRegisters(const vector<Statement_ptr> &statements, size_t slots, Globals &globals,
+                                   bool superinstructions) {
+    RegisterCompiler compiler {globals, superinstructions};
+    return compiler.compile(statements, slots);
+}
+
+RegisterCompiler::RegisterCompiler(Globals &globals, bool superinstructions)
+    : globals{globals}, superinstructions{superinstructions} {}
+
+shared_ptr<Chunk> RegisterCompiler::compile(const vector<Statement_ptr> &statements, size_t slots) {
+    return compileBody(statements, slots);
+}
+
+shared_ptr<Chunk> RegisterCompiler::compileBody(const vector<Statement_ptr> &statements, size_t slots) {
+    auto compiled = make_shared<Chunk>();
+
+    // retain the enclosing function's state
+    auto enclosing = chunk;
+    auto enclosingLocals = locals;
+    auto enclosingUsed = move(used);
+
+    chunk = compiled.get();
+    locals = checked(slots, "local variables");
+    used.clear();
+
+    for (const auto &statement : statements) {
+        compile(*statement);
+    }
+
+    // falling off the end returns nil
+    auto nil = allocate();
+    emit(RegisterOp::LOAD_NIL, nil);
+    emit(RegisterOp::RETURN, nil);
+
+    // the temporaries only ever grow
+    compiled->stackSize = locals + used.size();
+
+    if (superinstructions) {
+        fuseInstructions(*compiled);
+    }
+
+    chunk = enclosing;
+    locals = enclosingLocals;
+    used = move(enclosingUsed);
+
+    return compiled;
+}
+
+void RegisterCompiler::compile(Statement &statement) {
+    statement.accept(*this);
+}
+
+int RegisterCompiler::compile(Expression &expression, int target) {
+    auto enclosingTarget = this->target;
+
+    this->target = target;
+    expression.accept(*this);
+    this->target = enclosingTarget;
+
+    return result;
+}
+
+
+// Register allocation
+
+int RegisterCompiler::allocate() {
+    auto free = find(used.begin(), used.end(), false);
+
+    if (free == used.end()) {
+        return allocate(1);
+    }
+
+    *free = true;
+    return locals + static_cast<int>(free - used.begin());
+}
+
+int RegisterCompiler::allocate(int count) {
+    auto last = find(used.rbegin(), used.rend(), true);
+    auto first = static_cast<size_t>(used.rend() - last);
+
+    checked(locals + first + count - 1, "registers");
+
+    used.resize(max(used.size(), first + count), false);
+    fill(used.begin() + first, used.begin() + first + count, true);
+
+    return locals + static_cast<int>(first);
+}
+
+void RegisterCompiler::release(int reg) {
+    // locals stay allocated to their variables
+    if (reg >= locals) {
+        used[reg - locals] = false;
+    }
+}
+
+int RegisterCompiler::destination() {
+    return target == ANY ? allocate() : target;
+}
+
+int RegisterCompiler::temporaryDestination() {
+    return target >= locals ? target : allocate();
+}
+
+int RegisterCompiler::finish(int reg) {
+    if (target == ANY or target == reg) {
+        return reg;
+    }
+
+    emit(RegisterOp::MOVE, target, reg);
+    release(reg);
+
+    return target;
+}
+
+
+// Emitting instructions
+
+void RegisterCompiler::emit(RegisterOp op, int a, int b, int c) {
+    // registers are checked on allocation, all other operands when they are produced
+    chunk->instructions.push_back({op, static_cast<uint16_t>(a), static_cast<uint16_t>(b), static_cast<uint16_t>(c)});
+}
+
+void RegisterCompiler::mark(const Token_ptr &token) {
+    chunk->tokens.emplace_back(chunk->instructions.size(), token);
+    line = token->line;
+}
+
+uint16_t RegisterCompiler::constant(Value value) {
+    auto &constants = chunk->constants;
+
+    // identical bits, so that e.g. 0 and -0 stay distinct
+    auto existing = find_if(constants.begin(), constants.end(), [&](const Value &constant) {
+        return memcmp(&constant, &value, sizeof(Value)) == 0;
+    });
+
+    auto index = existing - constants.begin();
+
+    if (existing == constants.end()) {
+        constants.push_back(value);
+    }
+
+    return checked(index, "constants");
+}
+
+uint16_t RegisterCompiler::global(const Token &name) {
+    line = name.line;
+    return checked(globals.bind(name.lexeme), "global variables");
+}
+
+size_t RegisterCompiler::emitJump(RegisterOp op, int condition) {
+    emit(op, condition);
+    return chunk->instructions.size() - 1;
+}
+
+uint16_t RegisterCompiler::callSite(Call &call) {
+    auto index = checked(chunk->callSites.size(), "calls");
+    chunk->callSites.push_back(call.site);
+    return index;
+}
+
+void RegisterCompiler::patchJump(size_t jump) {
+    chunk->instructions[jump].b = checked(chunk->instructions.size(), "instructions");
+}
+
+int RegisterCompiler::arguments(Call &call) {
+    auto count = static_cast<int>(call.arguments.size());
+    auto base = allocate(count + 1);
+
+    compile(*call.callee, base);
+
+    for (int i = 0; i < count; ++i) {
+        compile(*call.arguments[i], base + 1 + i);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        release(base + 1 + i);
+    }
+
+    return base;
+}
+
+uint16_t RegisterCompiler::checked(size_t value, const char *what) {
+    if (value > numeric_limits<uint16_t>::max()) {
+        throw CompileError(line, string{"Too many "} + what + " in one function.");
+    }
+
+    return static_cast<uint16_t>(value);
+}
+
+
+// Statement Visitor
+
+void RegisterCompiler::visit(ExpressionStatement &statement) {
+    release(compile(*statement.expression));
+}
+
+void RegisterCompiler::visit(Print &statement) {
+    auto value = compile(*statement.expression);
+    emit(RegisterOp::PRINT, value);
+    release(value);
+}
+
+void RegisterCompiler::visit(Block &statement) {
+    // the block's variables have their own registers in the current frame
+    for (const auto &s : statement.statements) {
+        compile(*s);
+    }
+}
+
+void RegisterCompiler::visit(Var &statement) {
+    auto &name = *statement.name;
+
+    if (statement.access == Access::LOCAL) {
+        if (statement.initializer) {
+            compile(*statement.initializer, statement.slot);
+        } else {
+            emit(RegisterOp::LOAD_NIL, statement.slot);
+        }
+
+        return;
+    }
+
+    int value;
+
+    if (statement.initializer) {
+        value = compile(*statement.initializer);
+    } else {
+        value = allocate();
+        emit(RegisterOp::LOAD_NIL, value);
+    }
+
+    if (statement.access == Access::GLOBAL) {
+        emit(RegisterOp::DEFINE_GLOBAL, global(name), value);
+    } else {
+        // a new Cell on every execution, so closures created in different iterations of a loop don't share it
+        emit(RegisterOp::NEW_CELL, statement.slot, value);
+    }
+
+    release(value);
+}
+
+void RegisterCompiler::visit(If &statement) {
+    auto condition = compile(*statement.condition);
+    auto elseJump = emitJump(RegisterOp::JUMP_IF_FALSE, condition);
+    release(condition);
+
+    compile(*statement.thenBranch);
+
+    if (statement.elseBranch) {
+        auto endJump = emitJump(RegisterOp::JUMP, 0);
+        patchJump(elseJump);
+        compile(*statement.elseBranch);
+        patchJump(endJump);
+    } else {
+        patchJump(elseJump);
+    }
+}
+
+void RegisterCompiler::visit(While &statement) {
+    auto start = checked(chunk->instructions.size(), "instructions");
+
+    auto condition = compile(*statement.condition);
+    auto exitJump = emitJump(RegisterOp::JUMP_IF_FALSE, condition);
+    release(condition);
+
+    compile(*statement.body);
+    emit(RegisterOp::JUMP, 0, start);
+
+    patchJump(exitJump);
+}
+
+void RegisterCompiler::visit(Function &statement) {
+    auto &name = *statement.name;
+    line = name.line;
+
+    statement.chunk = compileBody(statement.body, statement.frameSize);
+
+    auto index = checked(chunk->functions.size(), "functions");
+    chunk->functions.push_back(statement.shared_from_this());
+
+    switch (statement.access) {
+        case Access::LOCAL:
+            emit(RegisterOp::CLOSURE, statement.slot, index);
+            break;
+
+        case Access::CELL: {
+            // a function that refers to itself captures its own variable, so the Cell has to exist before the closure
+            auto closure = allocate();
+
+            emit(RegisterOp::LOAD_NIL, closure);
+            emit(RegisterOp::NEW_CELL, statement.slot, closure);
+            emit(RegisterOp::CLOSURE, closure, index);
+            emit(RegisterOp::SET_CELL, statement.slot, closure);
+
+            release(closure);
+            break;
+        }
+
+        case Access::GLOBAL: {
+            auto closure = allocate();
+
+            emit(RegisterOp::CLOSURE, closure, index);
+            emit(RegisterOp::DEFINE_GLOBAL, global(name), closure);
+
+            release(closure);
+            break;
+        }
+
+        case Access::UPVALUE: ; // Unreachable, declarations are never upvalues
+    }
+}
+
+void RegisterCompiler::visit(Return &statement) {
+    if (statement.tailCall) {
+        auto &call = *statement.tailCall;
+        auto base = arguments(call);
+
+        emit(RegisterOp::TAIL_CALL, base, static_cast<int>(call.arguments.size()), callSite(call));
+        mark(call.paren);
+
+        release(base);
+        return;
+    }
+
+    int value;
+
+    if (statement.value) {
+        value = compile(*statement.value);
+    } else {
+        value = allocate();
+        emit(RegisterOp::LOAD_NIL, value);
+    }
+
+    emit(RegisterOp::RETURN, value);
+    release(value);
+}
+
+
+// Expression Visitor
+
+void RegisterCompiler::visit(Binary &expression) {
+    auto left = compile(*expression.left);
+
+    // reading a local directly is only safe if the right operand doesn't assign to it first
+    if (left < locals and assignsLocal(*expression.right, left)) {
+        auto copy = allocate();
+        emit(RegisterOp::MOVE, copy, left);
+        left = copy;
+    }
+
+    auto right = compile(*expression.right);
+
+    release(left);
+    release(right);
+
+    auto destination = this->destination();
+
+    switch (expression.token->type) {
+        case TokenType::MINUS: emit(RegisterOp::SUBTRACT, destination, left, right); break;
+        case TokenType::SLASH: emit(RegisterOp::DIVIDE, destination, left, right); break;
+        case TokenType::STAR: emit(RegisterOp::MULTIPLY, destination, left, right); break;
+        case TokenType::PLUS: emit(RegisterOp::ADD, destination, left, right); break;
+        case TokenType::GREATER: emit(RegisterOp::GREATER, destination, left, right); break;
+        case TokenType::GREATER_EQUAL: emit(RegisterOp::GREATER_EQUAL, destination, left, right); break;
+        case TokenType::LESS: emit(RegisterOp::LESS, destination, left, right); break;
+        case TokenType::LESS_EQUAL: emit(RegisterOp::LESS_EQUAL, destination, left, right); break;
+        case TokenType::BANG_EQUAL: emit(RegisterOp::NOT_EQUAL, destination, left, right); break;
+        case TokenType::EQUAL_EQUAL: emit(RegisterOp::EQUAL, destination, left, right); break;
+        default: ; // Unreachable
+    }
+
+    mark(expression.token);
+    result = destination;
+}
+
+void RegisterCompiler::visit(Grouping &expression) {
+    result = compile(*expression.content, target);
+}
+
+void RegisterCompiler::visit(Literal &expression) {
+    const auto &token = *expression.token;
+    const string &lexeme = token.lexeme;
+
+    line = token.line;
+
+    auto destination = this->destination();
+
+    switch (token.type) {
+        case TokenType::NIL: emit(RegisterOp::LOAD_NIL, destination); break;
+        case TokenType::TRUE: emit(RegisterOp::LOAD_BOOLEAN, destination, 1); break;
+        case TokenType::FALSE: emit(RegisterOp::LOAD_BOOLEAN, destination, 0); break;
+
+        case TokenType::NUMBER: {
+            emit(RegisterOp::LOAD_CONSTANT, destination, constant(Value::number(stod(lexeme))));
+            break;
+        }
+
+        case TokenType::STRING: {
+            auto symbol = String::NewSymbol(lexeme.substr(1, lexeme.length() - 2));
+            emit(RegisterOp::LOAD_CONSTANT, destination, constant(symbol));
+            break;
+        }
+
+        default: ;
+    }
+
+    result = destination;
+}
+
+void RegisterCompiler::visit(Logical &expression) {
+    // the left operand is stored before the right one is evaluated, which may read the variable being assigned
+    auto destination = temporaryDestination();
+
+    compile(*expression.left, destination);
+
+    // a and b = b if a, else a; a or b = a if a, else b
+    auto op = expression.token->type == TokenType::AND ? RegisterOp::JUMP_IF_FALSE : RegisterOp::JUMP_IF_TRUE;
+    auto endJump = emitJump(op, destination);
+
+    compile(*expression.right, destination);
+    patchJump(endJump);
+
+    result = finish(destination);
+}
+
+void RegisterCompiler::visit(Unary &expression) {
+    auto operand = compile(*expression.operand);
+    release(operand);
+
+    auto destination = this->destination();
+
+    if (expression.token->type == TokenType::MINUS) {
+        emit(RegisterOp::NEGATE, destination, operand);
+        mark(expression.token);
+    } else {
+        emit(RegisterOp::NOT, destination, operand);
+    }
+
+    result = destination;
+}
+
+void RegisterCompiler::visit(Variable &expression) {
+    auto &name = *expression.name;
+    line = name.line;
+
+    if (expression.access == Access::LOCAL) {
+        result = finish(expression.slot);
+        return;
+    }
+
+    auto destination = this->destination();
+
+    switch (expression.access) {
+        case Access::GLOBAL:
+            emit(RegisterOp::GET_GLOBAL, destination, global(name));
+            mark(expression.name);
+            break;
+
+        case Access::CELL:
+            emit(RegisterOp::GET_CELL, destination, expression.slot);
+            break;
+
+        case Access::UPVALUE:
+            emit(RegisterOp::GET_UPVALUE, destination, checked(expression.slot, "upvalues"));
+            break;
+
+        case Access::LOCAL: ; // Handled above
+    }
+
+    result = destination;
+}
+
+void RegisterCompiler::visit(Assign &expression) {
+    auto &name = *expression.name;
+
+    if (expression.access == Access::LOCAL) {
+        compile(*expression.value, expression.slot);
+        line = name.line;
+
+        result = finish(expression.slot);
+        return;
+    }
+
+    auto value = compile(*expression.value, target);
+    line = name.line;
+
+    switch (expression.access) {
+        case Access::GLOBAL:
+            emit(RegisterOp::SET_GLOBAL, global(name), value);
+            mark(expression.name);
+            break;
+
+        case Access::CELL:
+            emit(RegisterOp::SET_CELL, expression.slot, value);
+            break;
+
+        case Access::UPVALUE:
+            emit(RegisterOp::SET_UPVALUE, checked(expression.slot, "upvalues"), value);
+            break;
+
+        case Access::LOCAL: ; // Handled above
+    }
+
+    result = value;
+}
+
+void RegisterCompiler::visit(Call &expression) {
+    auto base = arguments(expression);
+
+    emit(RegisterOp::CALL, base, static_cast<int>(expression.arguments.size()), callSite(expression));
+    mark(expression.paren);
+
+    result = finish(base);
+}
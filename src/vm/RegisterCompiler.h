@@ -0,0 +1,126 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_REGISTERCOMPILER_H
+#define LOX_INTERPRETER_REGISTERCOMPILER_H
+
+#include "Chunk.h"
+#include "data/expression.h"
+#include "data/statement.h"
+#include "interpreter/Globals.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// compiles a resolved program into register code for its top-level code, given the size of the top-level frame, and
+// fuses common sequences of instructions into superinstructions unless told not to
+std::shared_ptr<Chunk> compileRegisters(const std::vector<Statement_ptr> &statements, std::size_t slots,
+                                        Globals &globals, bool superinstructions = true);
+
+/*
+ * Translates the syntax tree, as annotated by the Resolver, into instructions for the register VM. Locals are the
+ * registers at the slots the Resolver assigned, so reading a local takes no instruction at all and assigning one
+ * computes the value right into it; `i = i + 1` is a single ADD.
+ *
+ * Temporaries live in the registers above the locals. Each one lives from the instruction that computes it to the one
+ * that consumes it, and the compiler emits instructions in order, so registers are allocated in a single linear scan
+ * over these intervals: a temporary takes the lowest free register when it is defined and frees it at its last use.
+ * The callee and arguments of a call need consecutive registers, which are taken above all registers in use, since the
+ * callee's frame overlaps the registers right behind them.
+ *
+ * Once a body is compiled, the peephole optimizer fuses common sequences of its instructions into superinstructions.
+ */
+class RegisterCompiler : public ExpressionVisitor, StatementVisitor {
+
+public:
+    explicit RegisterCompiler(Globals &globals, bool superinstructions = true);
+
+    std::shared_ptr<Chunk> compile(const std::vector<Statement_ptr> &statements, std::size_t slots);
+
+    // Member functions for Statement visitor interface
+    void visit(ExpressionStatement &statement) override;
+    void visit(Print &statement) override;
+    void visit(Block &statement) override;
+    void visit(Var &statement) override;
+    void visit(If &statement) override;
+    void visit(While &statement) override;
+    void visit(Function &statement) override;
+    void visit(Return &statement) override;
+
+    // Member functions for Expression visitor interface
+    void visit(Binary &expression) override;
+    void visit(Grouping &expression) override;
+    void visit(Literal &expression) override;
+    void visit(Logical &expression) override;
+    void visit(Unary &expression) override;
+    void visit(Variable &expression) override;
+    void visit(Assign &expression) override;
+    void visit(Call &expression) override;
+
+private:
+    // for compile(expression, target): no particular register
+    static constexpr int ANY = -1;
+
+    Globals &globals;
+    bool superinstructions;
+
+    Chunk *chunk = nullptr;
+
+    // the frame size of the function being compiled, i.e. the first temporary, and which temporaries are in use
+    int locals = 0;
+    std::vector<bool> used;
+
+    // the register the expression being compiled should compute its value into (or ANY), and where it did
+    int target = ANY;
+    int result = ANY;
+
+    // the line of the most recent token compiled, to report errors at
+    int line = 0;
+
+    void compile(Statement &statement);
+
+    // compiles an expression and returns the register holding its value, which is target unless that is ANY
+    int compile(Expression &expression, int target = ANY);
+
+    std::shared_ptr<Chunk> compileBody(const std::vector<Statement_ptr> &statements, std::size_t slots);
+
+    // Register allocation
+    int allocate();
+    int allocate(int count);
+    void release(int reg);
+
+    // the register an expression should compute its value into: the target, or else a new temporary
+    int destination();
+
+    // the target, if it is a temporary, or else a new temporary, for expressions that write their destination before
+    // they're done reading other registers
+    int temporaryDestination();
+
+    // moves the result of an expression into the target, if it isn't there already
+    int finish(int reg);
+
+    void emit(RegisterOp op, int a, int b = 0, int c = 0);
+
+    // associates the instruction just emitted with a token to report its runtime errors at
+    void mark(const Token_ptr &token);
+
+    std::uint16_t constant(Value value);
+    std::uint16_t global(const Token &name);
+    std::uint16_t callSite(Call &call);
+
+    // emits a jump with a target to be patched once it is known, returning the jump's index
+    std::size_t emitJump(RegisterOp op, int condition);
+    void patchJump(std::size_t jump);
+
+    // compiles the callee and arguments of a call into consecutive registers and returns the first
+    int arguments(Call &call);
+
+    // operands are 16 bit
+    std::uint16_t checked(std::size_t value, const char *what);
+};
+
+
+#endif //LOX_INTERPRETER_REGISTERCOMPILER_H
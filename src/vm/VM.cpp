@@ -0,0 +1,936 @@
+//
+// Created on 2026-10-18.
+//
+
+#include "VM.h"
+
+#include "interpreter/CallSite.h"
+#include "jit/BaselineJit.h"
+#include "interpreter/RuntimeError.h"
+#include "data/statement.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <tuple>
+
+using namespace std;
+
+VM::VM(Interpreter &interpreter)
+    : interpreter{interpreter}, globals{*interpreter.globals}, stack(STACK_SIZE), top{stack.data()} {
+
+    interpreter.heap.addRoots(this);
+}
+
+VM::~VM() {
+    interpreter.heap.removeRoots(this);
+}
+
+void VM::markRoots(Heap &heap) {
+    for (auto value = stack.data(); value < top; ++value) {
+        heap.mark(*value);
+    }
+
+    // the callees are on the stack as well, except for tail calls that have since been replaced
+    for (const auto &frame : frames) {
+        heap.mark(frame.function);
+    }
+}
+
+void VM::interpret(const Chunk &script, size_t slots) {
+    // discard frames left behind by a runtime error in a previous run
+    frames.clear();
+    usingRegisters = false;
+
+    // the top-level frame holds the locals of top-level blocks
+    top = stack.data();
+    resize(stack.data() + slots);
+
+    frames.push_back({nullptr, &script, script.code.data(), nullptr, stack.data()});
+    run();
+}
+
+void VM::interpretRegisters(const Chunk &script) {
+    frames.clear();
+    usingRegisters = true;
+
+    top = stack.data();
+    resize(stack.data() + script.stackSize);
+
+    frames.push_back({nullptr, &script, nullptr, script.instructions.data(), stack.data()});
+
+    if (profiling) {
+        runRegisters<true>();
+    } else {
+        runRegisters<false>();
+    }
+}
+
+void VM::printProfile(ostream &out) const {
+    vector<tuple<uint64_t, size_t, size_t>> counts;
+    uint64_t total = 0;
+
+    for (size_t first = 0; first < REGISTER_OPS; ++first) {
+        for (size_t second = 0; second < REGISTER_OPS; ++second) {
+            if (pairs[first][second] > 0) {
+                counts.emplace_back(pairs[first][second], first, second);
+                total += pairs[first][second];
+            }
+        }
+    }
+
+    sort(counts.rbegin(), counts.rend());
+
+    for (const auto &[count, first, second] : counts) {
+        out << "[pairs] " << nameOf(RegisterOp(first)) << " " << nameOf(RegisterOp(second)) << ": " << count
+            << " (" << fixed << setprecision(1) << 100.0 * count / total << "%)\n";
+    }
+}
+
+void VM::resize(Value *end) {
+    // values above the top may be stale, pointing to objects that have been collected since
+    if (end > top) {
+        fill(top, end, Value::nil());
+    }
+
+    top = end;
+}
+
+
+// Calls
+
+void VM::checkCall(const Value &callee, int count, size_t offset) {
+    int arity;
+
+    if (callee.is<FunctionObject>()) {
+        arity = callee.as<FunctionObject>()->arity();
+    } else if (callee.is<Native>()) {
+        arity = callee.as<Native>()->arity();
+    } else {
+        error(offset, "Can only call functions and classes.");
+    }
+
+    if (count != arity) {
+        error(offset, "Expected " + to_string(arity) + " arguments but got " + to_string(count) + ".");
+    }
+}
+
+VM::CallFrame VM::enter(const FunctionObject &function, Value *slots, int count, size_t offset) {
+    auto &declaration = *function.declaration;
+    auto &chunk = *declaration.chunk;
+
+    if (slots + chunk.stackSize > stack.data() + stack.size()) {
+        error(offset, "Stack overflow.");
+    }
+
+    // the stack VM pushes temporaries above the locals, the register VM addresses them; either way the locals after the
+    // parameters start out nil, or with a value left behind by the caller that is overwritten before it is read
+    resize(slots + (usingRegisters ? chunk.stackSize : declaration.frameSize));
+
+    // captured parameters move into Cells before the body can create closures over them
+    for (auto slot : declaration.cells) {
+        slots[slot] = Cell::New(slots[slot]);
+    }
+
+    return {&function, &chunk, chunk.code.data(), chunk.instructions.data(), slots};
+}
+
+size_t VM::offset(const uint8_t *ip) const {
+    return ip - frames.back().chunk->code.data();
+}
+
+size_t VM::offset(const Instruction *pc) const {
+    return pc - frames.back().chunk->instructions.data();
+}
+
+void VM::undefined(size_t offset) {
+    auto &name = frames.back().chunk->tokenAt(offset);
+    error(offset, "Undefined variable \'" + name.lexeme + "\'.");
+}
+
+void VM::error(size_t offset, const string &message) {
+    throw RuntimeError(frames.back().chunk->tokenAt(offset), message);
+}
+
+
+// Execution
+
+void VM::run() {
+    // the state of the current frame, kept in locals to spare the indirection
+    CallFrame *frame;
+    const uint8_t *ip;
+    Value *slots;
+    const Value *constants;
+
+    auto load = [&] {
+        frame = &frames.back();
+        ip = frame->ip;
+        slots = frame->slots;
+        constants = frame->chunk->constants.data();
+    };
+
+    auto readShort = [&] {
+        uint16_t value = ip[0] | (ip[1] << 8);
+        ip += 2;
+        return value;
+    };
+
+    auto arithmetic = [&](auto op) {
+        auto left = top[-2];
+        auto right = top[-1];
+
+        if (not (left.isNumber() and right.isNumber())) {
+            error(offset(ip), "Operands of arithmetic operation (+, -, *, /) must be of type Number.");
+        }
+
+        --top;
+        top[-1] = Value::number(op(left.asNumber(), right.asNumber()));
+    };
+
+    auto comparison = [&](auto op) {
+        auto left = top[-2];
+        auto right = top[-1];
+
+        if (not (left.isNumber() and right.isNumber())) {
+            error(offset(ip), "Operands of arithmetic comparison (>, >=, <, <=) must be of type Number.");
+        }
+
+        --top;
+        top[-1] = Value::boolean(op(left.asNumber(), right.asNumber()));
+    };
+
+#ifdef LOX_COMPUTED_GOTO
+    // every handler ends in its own indirect jump to the next one, which the branch predictor can tell apart
+    static const void *handlers[] = {
+        &&handle_CONSTANT, &&handle_NIL, &&handle_TRUE, &&handle_FALSE, &&handle_POP, &&handle_GET_LOCAL,
+        &&handle_SET_LOCAL, &&handle_DEFINE_LOCAL, &&handle_DEFINE_CELL, &&handle_GET_CELL, &&handle_SET_CELL,
+        &&handle_GET_UPVALUE, &&handle_SET_UPVALUE, &&handle_GET_GLOBAL, &&handle_SET_GLOBAL, &&handle_DEFINE_GLOBAL,
+        &&handle_EQUAL, &&handle_NOT_EQUAL, &&handle_GREATER, &&handle_GREATER_EQUAL, &&handle_LESS,
+        &&handle_LESS_EQUAL, &&handle_ADD, &&handle_SUBTRACT, &&handle_MULTIPLY, &&handle_DIVIDE, &&handle_NOT,
+        &&handle_NEGATE, &&handle_PRINT, &&handle_JUMP, &&handle_JUMP_IF_FALSE, &&handle_LOOP, &&handle_CALL,
+        &&handle_TAIL_CALL, &&handle_CLOSURE, &&handle_RETURN
+    };
+
+    static_assert(size(handlers) == size_t(OpCode::RETURN) + 1, "one handler per opcode, in order");
+
+#define CASE(op) case OpCode::op: handle_##op
+#define DISPATCH() goto *handlers[*ip++]
+#else
+#define CASE(op) case OpCode::op
+#define DISPATCH() break
+#endif
+
+    load();
+
+    // with computed goto, the switch only dispatches the first instruction
+    while (true) {
+        switch (static_cast<OpCode>(*ip++)) {
+
+            CASE(CONSTANT):
+                *top++ = constants[readShort()];
+                DISPATCH();
+
+            CASE(NIL):
+                *top++ = Value::nil();
+                DISPATCH();
+
+            CASE(TRUE):
+                *top++ = Value::boolean(true);
+                DISPATCH();
+
+            CASE(FALSE):
+                *top++ = Value::boolean(false);
+                DISPATCH();
+
+            CASE(POP):
+                --top;
+                DISPATCH();
+
+            // Variables
+
+            CASE(GET_LOCAL):
+                *top++ = slots[readShort()];
+                DISPATCH();
+
+            CASE(SET_LOCAL):
+                slots[readShort()] = top[-1];
+                DISPATCH();
+
+            CASE(DEFINE_LOCAL):
+                slots[readShort()] = *--top;
+                DISPATCH();
+
+            CASE(DEFINE_CELL): {
+                // a new Cell on every execution, so closures created in different iterations of a loop don't share it
+                auto slot = readShort();
+                slots[slot] = Cell::New(top[-1]);
+                --top;
+                DISPATCH();
+            }
+
+            CASE(GET_CELL):
+                *top++ = slots[readShort()].as<Cell>()->get();
+                DISPATCH();
+
+            CASE(SET_CELL):
+                slots[readShort()].as<Cell>()->set(top[-1]);
+                DISPATCH();
+
+            CASE(GET_UPVALUE):
+                *top++ = frame->function->upvalues()[readShort()]->get();
+                DISPATCH();
+
+            CASE(SET_UPVALUE):
+                frame->function->upvalues()[readShort()]->set(top[-1]);
+                DISPATCH();
+
+            CASE(GET_GLOBAL): {
+                auto value = globals.find(readShort());
+
+                if (not value) {
+                    undefined(offset(ip));
+                }
+
+                *top++ = *value;
+                DISPATCH();
+            }
+
+            CASE(SET_GLOBAL): {
+                if (not globals.replace(readShort(), top[-1])) {
+                    undefined(offset(ip));
+                }
+
+                DISPATCH();
+            }
+
+            CASE(DEFINE_GLOBAL): {
+                auto index = readShort();
+                globals.define(index, top[-1]);
+                --top;
+                DISPATCH();
+            }
+
+            // Operators
+
+            CASE(EQUAL):
+                --top;
+                top[-1] = Value::boolean(top[-1] == top[0]);
+                DISPATCH();
+
+            CASE(NOT_EQUAL):
+                --top;
+                top[-1] = Value::boolean(top[-1] != top[0]);
+                DISPATCH();
+
+            CASE(GREATER):
+                comparison([](double left, double right) { return left > right; });
+                DISPATCH();
+
+            CASE(GREATER_EQUAL):
+                comparison([](double left, double right) { return left >= right; });
+                DISPATCH();
+
+            CASE(LESS):
+                comparison([](double left, double right) { return left < right; });
+                DISPATCH();
+
+            CASE(LESS_EQUAL):
+                comparison([](double left, double right) { return left <= right; });
+                DISPATCH();
+
+            CASE(ADD): {
+                auto left = top[-2];
+                auto right = top[-1];
+
+                if (left.isNumber() and right.isNumber()) {
+                    --top;
+                    top[-1] = Value::number(left.asNumber() + right.asNumber());
+                    DISPATCH();
+                }
+
+                auto handler = plusHandlers[size_t(kindOf(left))][size_t(kindOf(right))];
+
+                if (not handler) {
+                    error(offset(ip), plusError(left));
+                }
+
+                // the operands stay on the stack while the result is allocated
+                auto result = handler(left, right);
+                --top;
+                top[-1] = result;
+                DISPATCH();
+            }
+
+            CASE(SUBTRACT):
+                arithmetic([](double left, double right) { return left - right; });
+                DISPATCH();
+
+            CASE(MULTIPLY):
+                arithmetic([](double left, double right) { return left * right; });
+                DISPATCH();
+
+            CASE(DIVIDE):
+                arithmetic([](double left, double right) { return left / right; });
+                DISPATCH();
+
+            CASE(NOT):
+                top[-1] = Value::boolean(not top[-1].isTruthy());
+                DISPATCH();
+
+            CASE(NEGATE):
+                if (not top[-1].isNumber()) {
+                    error(offset(ip), "Operand of unary minus (-) must be of type Number.");
+                }
+
+                top[-1] = Value::number(-top[-1].asNumber());
+                DISPATCH();
+
+            // Statements
+
+            CASE(PRINT):
+                cout << *--top << "\n";
+                DISPATCH();
+
+            CASE(JUMP): {
+                auto offset = readShort();
+                ip += offset;
+                DISPATCH();
+            }
+
+            CASE(JUMP_IF_FALSE): {
+                auto offset = readShort();
+
+                if (not top[-1].isTruthy()) {
+                    ip += offset;
+                }
+
+                DISPATCH();
+            }
+
+            CASE(LOOP): {
+                auto offset = readShort();
+                ip -= offset;
+                DISPATCH();
+            }
+
+            // Functions
+
+            CASE(CALL): {
+                int count = *ip++;
+                auto callee = top[-count - 1];
+
+                checkCall(callee, count, offset(ip));
+
+                if (callee.is<FunctionObject>()) {
+                    frame->ip = ip;
+                    frames.push_back(enter(*callee.as<FunctionObject>(), top - count, count, offset(ip)));
+                    load();
+                } else {
+                    auto result = callee.as<Native>()->invoke(interpreter, top - count);
+                    top -= count;
+                    top[-1] = result;
+                }
+
+                DISPATCH();
+            }
+
+            CASE(TAIL_CALL): {
+                int count = *ip++;
+                auto callee = top[-count - 1];
+
+                checkCall(callee, count, offset(ip));
+
+                if (callee.is<FunctionObject>()) {
+                    // the callee and its arguments take the place of the current function and its frame
+                    auto base = slots - 1;
+                    copy(top - count - 1, top, base);
+                    top = base + count + 1;
+
+                    *frame = enter(*callee.as<FunctionObject>(), slots, count, offset(ip));
+                    load();
+                    DISPATCH();
+                }
+
+                auto result = callee.as<Native>()->invoke(interpreter, top - count);
+                top -= count;
+                top[-1] = result;
+
+                // return the result
+                [[fallthrough]];
+            }
+
+            CASE(RETURN): {
+                auto result = top[-1];
+                auto returning = frames.back();
+                frames.pop_back();
+
+                if (frames.empty()) {
+                    top = stack.data();
+                    return;
+                }
+
+                // the callee's stack slot receives the result
+                top = returning.slots;
+                top[-1] = result;
+
+                load();
+                DISPATCH();
+            }
+
+            CASE(CLOSURE): {
+                auto &declaration = frame->chunk->functions[readShort()];
+                auto closure = FunctionObject::New(declaration, slots, frame->function);
+                *top++ = closure;
+                DISPATCH();
+            }
+        }
+    }
+}
+
+#undef CASE
+#undef DISPATCH
+
+template<bool profile>
+void VM::runRegisters() {
+    // the state of the current frame, kept in locals to spare the indirection
+    CallFrame *frame;
+    const Instruction *code;
+    const Instruction *pc;
+    Value *slots;
+    const Value *constants;
+    const shared_ptr<CallSite> *callSites;
+
+    // whether the code of the current frame runs as machine code, or may still get hot enough for the baseline JIT to
+    // compile it
+    bool warm;
+
+    auto load = [&] {
+        frame = &frames.back();
+        code = frame->chunk->instructions.data();
+        pc = frame->pc;
+        slots = frame->slots;
+        constants = frame->chunk->constants.data();
+        callSites = frame->chunk->callSites.data();
+        warm = jit and (frame->chunk->native or frame->chunk->hotness < JIT_THRESHOLD);
+    };
+
+    auto arithmetic = [&](const Instruction &instruction, auto op) {
+        auto left = slots[instruction.b];
+        auto right = slots[instruction.c];
+
+        if (not (left.isNumber() and right.isNumber())) {
+            error(offset(pc), "Operands of arithmetic operation (+, -, *, /) must be of type Number.");
+        }
+
+        slots[instruction.a] = Value::number(op(left.asNumber(), right.asNumber()));
+    };
+
+    auto comparison = [&](const Instruction &instruction, auto op) {
+        auto left = slots[instruction.b];
+        auto right = slots[instruction.c];
+
+        if (not (left.isNumber() and right.isNumber())) {
+            error(offset(pc), "Operands of arithmetic comparison (>, >=, <, <=) must be of type Number.");
+        }
+
+        slots[instruction.a] = Value::boolean(op(left.asNumber(), right.asNumber()));
+    };
+
+    // Once the current frame's code is hot, runs it as machine code from the instruction at index on, and continues with
+    // the instruction the machine code leaves to the interpreter at
+    auto native = [&](size_t index) {
+        auto &chunk = *frame->chunk;
+
+        if (not chunk.native) {
+            // compiled at most once: code that couldn't be, or whose machine code was dropped, stays interpreted
+            if (chunk.hotness == JIT_THRESHOLD) {
+                warm = false;
+                return;
+            }
+
+            if (++chunk.hotness < JIT_THRESHOLD) {
+                return;
+            }
+
+            auto name = frame->function ? frame->function->declaration->name->lexeme : "script";
+            chunk.native = compileNative(chunk, name);
+
+            if (not chunk.native) {
+                warm = false;
+                return;
+            }
+        }
+
+        auto resume = chunk.native->run(slots, index);
+        pc = code + resume;
+
+        if (code[resume].op != RegisterOp::RETURN and ++chunk.deopts == DEOPT_LIMIT) {
+            // the operands aren't Numbers often enough for the machine code to pay off
+            chunk.native.reset();
+            warm = false;
+        }
+    };
+
+    auto less = [&](const Value &left, const Value &right) {
+        if (not (left.isNumber() and right.isNumber())) {
+            error(offset(pc), "Operands of arithmetic comparison (>, >=, <, <=) must be of type Number.");
+        }
+
+        return left.asNumber() < right.asNumber();
+    };
+
+#ifdef LOX_COMPUTED_GOTO
+    static const void *handlers[] = {
+        &&handle_MOVE, &&handle_LOAD_CONSTANT, &&handle_LOAD_NIL, &&handle_LOAD_BOOLEAN, &&handle_GET_CELL,
+        &&handle_SET_CELL, &&handle_NEW_CELL, &&handle_GET_UPVALUE, &&handle_SET_UPVALUE, &&handle_GET_GLOBAL,
+        &&handle_SET_GLOBAL, &&handle_DEFINE_GLOBAL, &&handle_EQUAL, &&handle_NOT_EQUAL, &&handle_GREATER,
+        &&handle_GREATER_EQUAL, &&handle_LESS, &&handle_LESS_EQUAL, &&handle_ADD, &&handle_SUBTRACT, &&handle_MULTIPLY,
+        &&handle_DIVIDE, &&handle_NOT, &&handle_NEGATE, &&handle_PRINT, &&handle_JUMP, &&handle_JUMP_IF_FALSE,
+        &&handle_JUMP_IF_TRUE, &&handle_ADD_CONSTANT, &&handle_SUBTRACT_CONSTANT, &&handle_JUMP_UNLESS_LESS,
+        &&handle_JUMP_UNLESS_LESS_CONSTANT, &&handle_JUMP_UNLESS_EQUAL_CONSTANT, &&handle_CALL, &&handle_TAIL_CALL,
+        &&handle_CLOSURE, &&handle_RETURN
+    };
+
+    static_assert(size(handlers) == size_t(RegisterOp::RETURN) + 1, "one handler per instruction, in order");
+
+#define CASE(op) case RegisterOp::op: handle_##op
+#define DISPATCH() do { fetch(); goto *handlers[size_t(instruction.op)]; } while (false)
+#else
+#define CASE(op) case RegisterOp::op
+#define DISPATCH() break
+#endif
+
+    Instruction instruction;
+
+    // the instruction dispatched last, while profiling
+    auto previous = REGISTER_OPS;
+
+    auto fetch = [&] {
+        instruction = *pc++;
+
+        if (profile) {
+            auto op = size_t(instruction.op);
+
+            if (previous < REGISTER_OPS) {
+                ++pairs[previous][op];
+            }
+
+            previous = op;
+        }
+    };
+
+    load();
+
+    while (true) {
+        fetch();
+
+        switch (instruction.op) {
+
+            CASE(MOVE):
+                slots[instruction.a] = slots[instruction.b];
+                DISPATCH();
+
+            CASE(LOAD_CONSTANT):
+                slots[instruction.a] = constants[instruction.b];
+                DISPATCH();
+
+            CASE(LOAD_NIL):
+                slots[instruction.a] = Value::nil();
+                DISPATCH();
+
+            CASE(LOAD_BOOLEAN):
+                slots[instruction.a] = Value::boolean(instruction.b != 0);
+                DISPATCH();
+
+            // Variables
+
+            CASE(GET_CELL):
+                slots[instruction.a] = slots[instruction.b].as<Cell>()->get();
+                DISPATCH();
+
+            CASE(SET_CELL):
+                slots[instruction.a].as<Cell>()->set(slots[instruction.b]);
+                DISPATCH();
+
+            CASE(NEW_CELL): {
+                auto cell = Cell::New(slots[instruction.b]);
+                slots[instruction.a] = cell;
+                DISPATCH();
+            }
+
+            CASE(GET_UPVALUE):
+                slots[instruction.a] = frame->function->upvalues()[instruction.b]->get();
+                DISPATCH();
+
+            CASE(SET_UPVALUE):
+                frame->function->upvalues()[instruction.a]->set(slots[instruction.b]);
+                DISPATCH();
+
+            CASE(GET_GLOBAL): {
+                auto value = globals.find(instruction.b);
+
+                if (not value) {
+                    undefined(offset(pc));
+                }
+
+                slots[instruction.a] = *value;
+                DISPATCH();
+            }
+
+            CASE(SET_GLOBAL):
+                if (not globals.replace(instruction.a, slots[instruction.b])) {
+                    undefined(offset(pc));
+                }
+
+                DISPATCH();
+
+            CASE(DEFINE_GLOBAL):
+                globals.define(instruction.a, slots[instruction.b]);
+                DISPATCH();
+
+            // Operators
+
+            CASE(EQUAL):
+                slots[instruction.a] = Value::boolean(slots[instruction.b] == slots[instruction.c]);
+                DISPATCH();
+
+            CASE(NOT_EQUAL):
+                slots[instruction.a] = Value::boolean(slots[instruction.b] != slots[instruction.c]);
+                DISPATCH();
+
+            CASE(GREATER):
+                comparison(instruction, [](double left, double right) { return left > right; });
+                DISPATCH();
+
+            CASE(GREATER_EQUAL):
+                comparison(instruction, [](double left, double right) { return left >= right; });
+                DISPATCH();
+
+            CASE(LESS):
+                comparison(instruction, [](double left, double right) { return left < right; });
+                DISPATCH();
+
+            CASE(LESS_EQUAL):
+                comparison(instruction, [](double left, double right) { return left <= right; });
+                DISPATCH();
+
+            CASE(ADD): {
+                auto left = slots[instruction.b];
+                auto right = slots[instruction.c];
+
+                if (left.isNumber() and right.isNumber()) {
+                    slots[instruction.a] = Value::number(left.asNumber() + right.asNumber());
+                    DISPATCH();
+                }
+
+                auto handler = plusHandlers[size_t(kindOf(left))][size_t(kindOf(right))];
+
+                if (not handler) {
+                    error(offset(pc), plusError(left));
+                }
+
+                // the operands stay in their registers while the result is allocated
+                auto result = handler(left, right);
+                slots[instruction.a] = result;
+                DISPATCH();
+            }
+
+            CASE(SUBTRACT):
+                arithmetic(instruction, [](double left, double right) { return left - right; });
+                DISPATCH();
+
+            CASE(MULTIPLY):
+                arithmetic(instruction, [](double left, double right) { return left * right; });
+                DISPATCH();
+
+            CASE(DIVIDE):
+                arithmetic(instruction, [](double left, double right) { return left / right; });
+                DISPATCH();
+
+            CASE(NOT):
+                slots[instruction.a] = Value::boolean(not slots[instruction.b].isTruthy());
+                DISPATCH();
+
+            CASE(NEGATE):
+                if (not slots[instruction.b].isNumber()) {
+                    error(offset(pc), "Operand of unary minus (-) must be of type Number.");
+                }
+
+                slots[instruction.a] = Value::number(-slots[instruction.b].asNumber());
+                DISPATCH();
+
+            // Statements
+
+            CASE(PRINT):
+                cout << slots[instruction.a] << "\n";
+                DISPATCH();
+
+            CASE(JUMP): {
+                auto backward = code + instruction.b < pc;
+                pc = code + instruction.b;
+
+                // the jump back to the start of a loop, which may have become hot
+                if (warm and backward) {
+                    native(instruction.b);
+                }
+
+                DISPATCH();
+            }
+
+            CASE(JUMP_IF_FALSE):
+                if (not slots[instruction.a].isTruthy()) {
+                    pc = code + instruction.b;
+                }
+
+                DISPATCH();
+
+            CASE(JUMP_IF_TRUE):
+                if (slots[instruction.a].isTruthy()) {
+                    pc = code + instruction.b;
+                }
+
+                DISPATCH();
+
+            // Superinstructions
+
+            CASE(ADD_CONSTANT): {
+                auto left = slots[instruction.b];
+                auto right = constants[instruction.c];
+
+                if (left.isNumber() and right.isNumber()) {
+                    slots[instruction.a] = Value::number(left.asNumber() + right.asNumber());
+                    DISPATCH();
+                }
+
+                auto handler = plusHandlers[size_t(kindOf(left))][size_t(kindOf(right))];
+
+                if (not handler) {
+                    error(offset(pc), plusError(left));
+                }
+
+                auto result = handler(left, right);
+                slots[instruction.a] = result;
+                DISPATCH();
+            }
+
+            CASE(SUBTRACT_CONSTANT): {
+                auto left = slots[instruction.b];
+                auto right = constants[instruction.c];
+
+                if (not (left.isNumber() and right.isNumber())) {
+                    error(offset(pc), "Operands of arithmetic operation (+, -, *, /) must be of type Number.");
+                }
+
+                slots[instruction.a] = Value::number(left.asNumber() - right.asNumber());
+                DISPATCH();
+            }
+
+            CASE(JUMP_UNLESS_LESS):
+                if (not less(slots[instruction.a], slots[instruction.b])) {
+                    pc = code + instruction.c;
+                }
+
+                DISPATCH();
+
+            CASE(JUMP_UNLESS_LESS_CONSTANT):
+                if (not less(slots[instruction.a], constants[instruction.b])) {
+                    pc = code + instruction.c;
+                }
+
+                DISPATCH();
+
+            CASE(JUMP_UNLESS_EQUAL_CONSTANT):
+                if (slots[instruction.a] != constants[instruction.b]) {
+                    pc = code + instruction.c;
+                }
+
+                DISPATCH();
+
+            // Functions
+
+            CASE(CALL): {
+                auto base = slots + instruction.a;
+                int count = instruction.b;
+                auto &site = *callSites[instruction.c];
+
+                if (not site.hit(*base)) {
+                    checkCall(*base, count, offset(pc));
+                    site.update(*base);
+                }
+
+                if (base->is<FunctionObject>()) {
+                    frame->pc = pc;
+                    frames.push_back(enter(*base->as<FunctionObject>(), base + 1, count, offset(pc)));
+                    load();
+
+                    if (warm) {
+                        native(0);
+                    }
+                } else {
+                    *base = base->as<Native>()->invoke(interpreter, base + 1);
+                }
+
+                DISPATCH();
+            }
+
+            CASE(TAIL_CALL): {
+                auto base = slots + instruction.a;
+                int count = instruction.b;
+                auto &site = *callSites[instruction.c];
+
+                if (not site.hit(*base)) {
+                    checkCall(*base, count, offset(pc));
+                    site.update(*base);
+                }
+
+                if (base->is<FunctionObject>()) {
+                    // the callee and its arguments take the place of the current function and its frame
+                    copy(base, base + count + 1, slots - 1);
+
+                    *frame = enter(*slots[-1].as<FunctionObject>(), slots, count, offset(pc));
+                    load();
+
+                    if (warm) {
+                        native(0);
+                    }
+
+                    DISPATCH();
+                }
+
+                *base = base->as<Native>()->invoke(interpreter, base + 1);
+
+                // return the result, which is in R[a] just like for RETURN
+                [[fallthrough]];
+            }
+
+            CASE(RETURN): {
+                auto result = slots[instruction.a];
+                auto returning = frames.back();
+                frames.pop_back();
+
+                if (frames.empty()) {
+                    top = stack.data();
+                    return;
+                }
+
+                // the callee's register in the caller receives the result
+                returning.slots[-1] = result;
+
+                load();
+                resize(slots + frame->chunk->stackSize);
+                DISPATCH();
+            }
+
+            CASE(CLOSURE): {
+                auto &declaration = frame->chunk->functions[instruction.b];
+                auto closure = FunctionObject::New(declaration, slots, frame->function);
+                slots[instruction.a] = closure;
+                DISPATCH();
+            }
+        }
+    }
+}
+
+#undef CASE
+#undef DISPATCH
@@ -0,0 +1,115 @@
+//
+// Created on 2026-10-18.
+//
+
+#ifndef LOX_INTERPRETER_VM_H
+#define LOX_INTERPRETER_VM_H
+
+#include "Chunk.h"
+#include "interpreter/Interpreter.h"
+#include "interpreter/Callable.h"
+#include "interpreter/Heap.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+ * Executes bytecode produced by the Compiler on a stack of Values. Each call's frame lives on the stack, starting with
+ * the arguments right above the callee, followed by the rest of its locals and then its temporaries, just like the
+ * tree-walking Interpreter's frames. Closures are FunctionObjects whose declarations carry their bytecode, with Cells as
+ * upvalues.
+ *
+ * Alternatively, the VM executes register code produced by the RegisterCompiler. Frames have the same layout, but the
+ * temporaries are registers addressed by the instructions rather than pushed and popped, and the stack extends to the
+ * last register of the current frame.
+ *
+ * The VM runs on the Interpreter's heap and shares its globals, so the natives it defines are available, and registers
+ * its stack with the heap as roots.
+ */
+class VM : public RootSet {
+
+public:
+    explicit VM(Interpreter &interpreter);
+    ~VM();
+
+    VM(const VM&) = delete;
+    VM& operator=(const VM&) = delete;
+
+    // runs the top-level code of a program, given the size of the top-level frame as determined by the Resolver
+    void interpret(const Chunk &script, std::size_t slots);
+
+    // runs the top-level code of a program compiled by the RegisterCompiler
+    void interpretRegisters(const Chunk &script);
+
+    void markRoots(Heap &heap) override;
+
+    // whether to count how often each instruction of the register VM is followed by each other one
+    bool profiling = false;
+
+    // prints the pairs of instructions counted while profiling, most frequent first
+    void printProfile(std::ostream &out) const;
+
+    // whether the register VM compiles hot code to machine code (see BaselineJit.h)
+    bool jit = false;
+
+private:
+    // Values, enough for thousands of nested calls
+    static constexpr std::size_t STACK_SIZE = 256 * 1024;
+
+    struct CallFrame {
+        // nullptr for the top level
+        const FunctionObject *function;
+        const Chunk *chunk;
+
+        // the next instruction, only up to date while another frame is on top
+        const std::uint8_t *ip;
+        const Instruction *pc;
+
+        // the frame's first local, i.e. its first argument
+        Value *slots;
+    };
+
+    Interpreter &interpreter;
+    Globals &globals;
+
+    // frames point into the stack, so it never grows
+    std::vector<Value> stack;
+    Value *top;
+
+    std::vector<CallFrame> frames;
+
+    // whether the program was compiled by the RegisterCompiler
+    bool usingRegisters = false;
+
+    void run();
+
+    template<bool profile>
+    void runRegisters();
+
+    // the number of times each instruction was followed by each other one, indexed by their RegisterOps
+    std::array<std::array<std::uint64_t, REGISTER_OPS>, REGISTER_OPS> pairs {};
+
+    // moves the top of the stack, clearing the values that come into its range
+    void resize(Value *end);
+
+    // checks whether the callee can be called with `count` arguments
+    void checkCall(const Value &callee, int count, std::size_t offset);
+
+    // sets up the frame for a call of function with the `count` arguments at slots
+    CallFrame enter(const FunctionObject &function, Value *slots, int count, std::size_t offset);
+
+    // the offset of the current frame's instruction that ends at ip or pc
+    std::size_t offset(const std::uint8_t *ip) const;
+    std::size_t offset(const Instruction *pc) const;
+
+    // raises a runtime error at the token of the current frame's instruction that ends at the offset
+    [[noreturn]] void error(std::size_t offset, const std::string &message);
+    [[noreturn]] void undefined(std::size_t offset);
+};
+
+
+#endif //LOX_INTERPRETER_VM_H